@@ -0,0 +1,58 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "BuildDriver.h"
+#include "OutputBuffer.h"
+
+// 并行构建多个源文件：Driver [-j N] [-o 目录] 文件、目录或通配符...
+// 每个文件写出 .tokens.txt、.ast.txt、.rpn.txt、.asm 四个中间文件，最后输出诊断信息和耗时汇总；
+// --gas 时汇编为 GAS 语法的完整程序，写成 .s
+int main(int argc, char** argv) {
+    BuildOptions options;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "-j") == 0) {
+            std::string value = arg.size() > 2 ? arg.substr(2) : (i + 1 < argc ? argv[++i] : "");
+            options.jobs = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (arg == "-o" && i + 1 < argc) {
+            options.outputDirectory = argv[++i];
+        }
+        else if (arg == "--no-artifacts") {
+            options.writeArtifacts = false;
+        }
+        else if (arg == "--pipeline") {
+            options.compile.pipelined = true;
+        }
+        else if (arg == "--gas") {
+            options.compile.syntax = AssemblySyntax::Gas;
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::cerr << "Usage: Driver [-j N] [-o dir] [--no-artifacts] [--pipeline] [--gas] files, directories or globs..." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> inputErrors;
+    std::vector<std::string> files = expandInputs(inputs, inputErrors);
+    for (const std::string& error : inputErrors) {
+        std::cerr << error << std::endl;
+    }
+
+    BuildReport report = buildFiles(files, options);
+
+    OutputBuffer errors(2);
+    printDiagnostics(report, errors);
+    errors.flush();
+
+    OutputBuffer console(1);
+    printTimingSummary(report, console);
+    console.flush();
+
+    return report.failed == 0 && inputErrors.empty() ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+﻿#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BuildDriver.h"
+#include "Compiler.h"
+#include "Interpreter.h"
+#include "OutputBuffer.h"
+
+// 验证生成的代码：Harness [-n 次数] [-o 目录] [--cc 编译器] [--expect-errors] 文件、目录或通配符...
+//
+// 每个文件编译成 GAS 汇编，与 runtime/runtime.c 一起用 cc 汇编链接后运行，
+// 把程序的输出和结束时各变量的值与 Interpreter 直接执行语法树的结果比较，
+// 一致时输出 PASS 和每次运行的 TSC 周期数。参照执行出错（除数为 0、下标越界）的文件记为 SKIP。
+// --expect-errors 时每个文件都应当编译失败并给出诊断信息，不汇编也不运行
+
+namespace fs = std::filesystem;
+
+namespace {
+    bool readFile(const std::string& path, std::string& content) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+    bool writeFile(const std::string& path, std::string_view content) {
+        OutputBuffer file;
+        if (!file.open(path)) {
+            return false;
+        }
+        file << content;
+        return file.close();
+    }
+
+    std::string quote(const std::string& text) {
+        std::string quoted = "'";
+        for (char c : text) {
+            if (c == '\'') {
+                quoted += "'\\''";
+            }
+            else {
+                quoted += c;
+            }
+        }
+        return quoted + "'";
+    }
+
+    struct Options {
+        long runs = 1000;
+        std::string directory;
+        std::string cc = "cc";
+        bool expectErrors = false;
+    };
+
+    // 检查一个文件，返回 0 通过，1 失败，2 跳过；message 为输出的说明
+    int check(const std::string& path, const Options& options, std::string& message) {
+        std::string source;
+        if (!readFile(path, source)) {
+            message = "cannot read file";
+            return 1;
+        }
+        if (options.expectErrors) {
+            const CompileResult& result = compile(source);
+            if (result.ok || result.diagnostics.empty()) {
+                message = "compiled without errors";
+                return 1;
+            }
+            message = result.diagnostics.front();
+            return 0;
+        }
+        // 参照执行不删除无用的赋值，这样也检查了删除本身是否正确
+        CompileOptions referenceOptions;
+        referenceOptions.generateRpn = false;
+        referenceOptions.generateAssembly = false;
+        referenceOptions.eliminateDeadAssignments = false;
+        const CompileResult& parsed = compile(source, referenceOptions);
+        if (!parsed.ok) {
+            message = parsed.diagnostics.empty() ? "compile failed" : parsed.diagnostics.front();
+            return 1;
+        }
+        Interpreter reference(parsed.ast);
+        if (!reference.run()) {
+            message = "reference: " + reference.error();
+            return 2;
+        }
+
+        // 下一次编译会覆盖 parsed，reference 之后只用到它自己保存的输出和变量
+        CompileOptions compileOptions;
+        compileOptions.syntax = AssemblySyntax::Gas;
+        const CompileResult& result = compile(source, compileOptions);
+        if (!result.ok) {
+            message = result.diagnostics.empty() ? "compile failed" : result.diagnostics.front();
+            return 1;
+        }
+
+        fs::path base = fs::path(options.directory) / fs::path(path).filename();
+        std::string assembly = base.string() + ".s";
+        std::string executable = base.string() + ".out";
+        std::string output = base.string() + ".stdout.txt";
+        std::string report = base.string() + ".report.txt";
+        if (!writeFile(assembly, result.assembly.view())) {
+            message = "cannot write " + assembly;
+            return 1;
+        }
+
+        std::string build = options.cc + " -O2 -no-pie -o " + quote(executable) + " " + quote(assembly) + " " + quote(HARNESS_RUNTIME);
+        if (std::system(build.c_str()) != 0) {
+            message = "assembling failed: " + build;
+            return 1;
+        }
+        std::string run = quote(executable) + " " + std::to_string(options.runs) + " >" + quote(output) + " 2>" + quote(report);
+        if (std::system(run.c_str()) != 0) {
+            message = "program exited abnormally";
+            return 1;
+        }
+
+        std::string actual;
+        readFile(output, actual);
+        if (actual != reference.output()) {
+            message = "output differs";
+            return 1;
+        }
+
+        // 报告中每行 "名字 = 值 ..."，最后一行是周期数
+        std::ifstream lines(report);
+        std::string line;
+        std::string cycles;
+        while (std::getline(lines, line)) {
+            if (line.compare(0, 7, "cycles:") == 0) {
+                cycles = line;
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string name, equals;
+            fields >> name >> equals;
+            std::vector<std::int32_t> values;
+            std::int32_t value;
+            while (fields >> value) {
+                values.push_back(value);
+            }
+            // 参照执行中没有赋过值的变量为 0
+            std::vector<std::int32_t> expected(values.size(), 0);
+            auto it = reference.variables().find(name);
+            if (it != reference.variables().end()) {
+                expected = it->second;
+            }
+            if (values != expected) {
+                message = "variable '" + name + "' differs";
+                return 1;
+            }
+        }
+        message = cycles.empty() ? "no timing" : cycles;
+        if (result.removedStatements != 0) {
+            message += ", " + std::to_string(result.removedStatements) + " dead statements removed";
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            options.runs = std::atol(argv[++i]);
+        }
+        else if (arg == "-o" && i + 1 < argc) {
+            options.directory = argv[++i];
+        }
+        else if (arg == "--cc" && i + 1 < argc) {
+            options.cc = argv[++i];
+        }
+        else if (arg == "--expect-errors") {
+            options.expectErrors = true;
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::cerr << "Usage: Harness [-n runs] [-o dir] [--cc compiler] [--expect-errors] files, directories or globs..." << std::endl;
+        return 1;
+    }
+    if (options.directory.empty()) {
+        options.directory = (fs::temp_directory_path() / "compiler_harness").string();
+    }
+    std::error_code error;
+    fs::create_directories(options.directory, error);
+    if (error) {
+        std::cerr << "Failed to create directory: " << options.directory << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> inputErrors;
+    std::vector<std::string> files = expandInputs(inputs, inputErrors);
+    for (const std::string& message : inputErrors) {
+        std::cerr << message << std::endl;
+    }
+
+    static const char* const verdicts[] = { "PASS", "FAIL", "SKIP" };
+    std::size_t counts[3] = { 0, 0, 0 };
+    OutputBuffer console(1);
+    for (const std::string& file : files) {
+        std::string message;
+        int verdict = check(file, options, message);
+        counts[verdict]++;
+        console << verdicts[verdict] << "  " << file << "  " << message << '\n';
+        console.flush();
+    }
+    console << counts[0] << " passed, " << counts[1] << " failed, " << counts[2] << " skipped\n";
+    console.flush();
+    return counts[1] == 0 && inputErrors.empty() ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+﻿#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 简单的基准测试框架：注册、计时，并以 JSON 输出结果（字段与 Google Benchmark 保持一致）
+namespace bench {
+
+    // 防止编译器把被测结果优化掉
+    template <typename T>
+    inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    class State {
+    public:
+        explicit State(std::uint64_t iterations) : iterations_(iterations), remaining_(iterations) {}
+
+        // 每轮循环调用一次，第一次调用时开始计时
+        bool keepRunning() {
+            if (!started_) {
+                started_ = true;
+                start_ = std::chrono::steady_clock::now();
+                cpuStart_ = std::clock();
+            }
+            if (remaining_ == 0) {
+                end_ = std::chrono::steady_clock::now();
+                cpuEnd_ = std::clock();
+                return false;
+            }
+            --remaining_;
+            return true;
+        }
+
+        // 每轮处理的字节数与元素数，用于计算吞吐量
+        void setBytesProcessed(std::uint64_t bytes) { bytes_ = bytes; }
+        void setItemsProcessed(std::uint64_t items) { items_ = items; }
+
+        std::uint64_t iterations() const { return iterations_; }
+        std::uint64_t bytesProcessed() const { return bytes_; }
+        std::uint64_t itemsProcessed() const { return items_; }
+
+        double realSeconds() const { return std::chrono::duration<double>(end_ - start_).count(); }
+        double cpuSeconds() const { return double(cpuEnd_ - cpuStart_) / CLOCKS_PER_SEC; }
+
+    private:
+        std::uint64_t iterations_;
+        std::uint64_t remaining_;
+        std::uint64_t bytes_ = 0;
+        std::uint64_t items_ = 0;
+        bool started_ = false;
+        std::chrono::steady_clock::time_point start_, end_;
+        std::clock_t cpuStart_ = 0, cpuEnd_ = 0;
+    };
+
+    struct Benchmark {
+        std::string name;
+        std::function<void(State&)> run;
+    };
+
+    inline std::vector<Benchmark>& registry() {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    inline void add(std::string name, std::function<void(State&)> run) {
+        registry().push_back({ std::move(name), std::move(run) });
+    }
+
+    struct Result {
+        std::string name;
+        std::uint64_t iterations;
+        double realNs;  // 每轮耗时
+        double cpuNs;
+        double bytesPerSecond;
+        double itemsPerSecond;
+    };
+
+    struct Options {
+        std::string filter;
+        std::string outFile;
+        double minTime = 0.2;  // 每个基准至少运行的秒数
+        int repetitions = 1;
+        bool list = false;
+    };
+
+    inline std::string jsonEscape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            }
+            else {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    inline void writeJson(std::ostream& os, const std::vector<Result>& results) {
+        char date[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        os << "{\n  \"context\": {\n";
+        os << "    \"date\": \"" << date << "\",\n";
+        os << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+        os << "    \"library_build_type\": \"release\"\n";
+#else
+        os << "    \"library_build_type\": \"debug\"\n";
+#endif
+        os << "  },\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            os << (i ? ",\n" : "\n") << "    {\n";
+            os << "      \"name\": \"" << jsonEscape(r.name) << "\",\n";
+            os << "      \"run_type\": \"iteration\",\n";
+            os << "      \"iterations\": " << r.iterations << ",\n";
+            os << "      \"real_time\": " << r.realNs << ",\n";
+            os << "      \"cpu_time\": " << r.cpuNs << ",\n";
+            os << "      \"time_unit\": \"ns\"";
+            if (r.bytesPerSecond > 0) {
+                os << ",\n      \"bytes_per_second\": " << r.bytesPerSecond;
+            }
+            if (r.itemsPerSecond > 0) {
+                os << ",\n      \"items_per_second\": " << r.itemsPerSecond;
+            }
+            os << "\n    }";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    inline Result runOne(const Benchmark& b, double minTime) {
+        // 根据上一轮的耗时放大迭代次数（每次最多 10 倍），直到总耗时超过 minTime
+        std::uint64_t iterations = 1;
+        for (;;) {
+            State state(iterations);
+            b.run(state);
+            double seconds = state.realSeconds();
+            if (seconds >= minTime || iterations >= (1ull << 40)) {
+                Result r;
+                r.name = b.name;
+                r.iterations = iterations;
+                r.realNs = seconds * 1e9 / iterations;
+                r.cpuNs = state.cpuSeconds() * 1e9 / iterations;
+                r.bytesPerSecond = seconds > 0 ? state.bytesProcessed() * double(iterations) / seconds : 0;
+                r.itemsPerSecond = seconds > 0 ? state.itemsProcessed() * double(iterations) / seconds : 0;
+                return r;
+            }
+            double scale = seconds > 0 ? 1.4 * minTime / seconds : 10.0;
+            iterations = std::max<std::uint64_t>(iterations + 1,
+                static_cast<std::uint64_t>(iterations * std::min(scale, 10.0)));
+        }
+    }
+
+    inline bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--filter=", 0) == 0) {
+                options.filter = arg.substr(9);
+            }
+            else if (arg.rfind("--out=", 0) == 0) {
+                options.outFile = arg.substr(6);
+            }
+            else if (arg.rfind("--min-time=", 0) == 0) {
+                options.minTime = std::stod(arg.substr(11));
+            }
+            else if (arg.rfind("--repetitions=", 0) == 0) {
+                options.repetitions = std::max(1, std::stoi(arg.substr(14)));
+            }
+            else if (arg == "--list") {
+                options.list = true;
+            }
+            else {
+                std::fprintf(stderr,
+                    "usage: %s [--filter=<substr>] [--out=<file.json>] [--min-time=<sec>] [--repetitions=<n>] [--list]\n",
+                    argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 运行所有匹配的基准；控制台输出可读表格，JSON 写到 --out 指定的文件（未指定时写到标准输出）
+    inline int runAll(int argc, char** argv) {
+        Options options;
+        if (!parseOptions(argc, argv, options)) {
+            return 1;
+        }
+
+        std::vector<Result> results;
+        for (const Benchmark& b : registry()) {
+            if (!options.filter.empty() && b.name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            if (options.list) {
+                std::cout << b.name << "\n";
+                continue;
+            }
+            for (int rep = 0; rep < options.repetitions; ++rep) {
+                Result r = runOne(b, options.minTime);
+                std::fprintf(stderr, "%-60s %14.1f ns %12llu it", r.name.c_str(), r.realNs,
+                    static_cast<unsigned long long>(r.iterations));
+                if (r.bytesPerSecond > 0) {
+                    std::fprintf(stderr, " %10.2f MB/s", r.bytesPerSecond / 1e6);
+                }
+                std::fprintf(stderr, "\n");
+                results.push_back(std::move(r));
+            }
+        }
+        if (options.list) {
+            return 0;
+        }
+
+        if (options.outFile.empty()) {
+            writeJson(std::cout, results);
+        }
+        else {
+            std::ofstream out(options.outFile);
+            if (!out) {
+                std::fprintf(stderr, "Failed to open file: %s\n", options.outFile.c_str());
+                return 1;
+            }
+            writeJson(out, results);
+        }
+        return 0;
+    }
+
+}
@@ -0,0 +1,219 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 基准测试用的合成输入。所有生成器都是确定性的，便于比较不同版本的结果
+namespace workloads {
+
+    // 线性同余随机数，保证在各平台上产生相同的序列
+    class Rng {
+    public:
+        explicit Rng(std::uint32_t seed) : state_(seed) {}
+        std::uint32_t next() {
+            state_ = state_ * 1664525u + 1013904223u;
+            return state_ >> 8;
+        }
+        std::uint32_t below(std::uint32_t n) { return next() % n; }
+
+    private:
+        std::uint32_t state_;
+    };
+
+    inline char randomOperator(Rng& rng) {
+        static const char ops[] = { '+', '-', '*', '/' };
+        return ops[rng.below(4)];
+    }
+
+    inline std::string identifier(std::size_t index, std::size_t length) {
+        std::string name = "v";
+        while (name.size() + 1 < length) {
+            name += static_cast<char>('a' + (index + name.size()) % 26);
+        }
+        name += std::to_string(index);
+        return name;
+    }
+
+    // 一条很长的扁平运算链：a = 1 + 2 * 3 - ... ;
+    inline std::string flatChain(std::size_t operators) {
+        Rng rng(1);
+        std::string src = "a = ";
+        src += std::to_string(rng.below(1000));
+        for (std::size_t i = 0; i < operators; ++i) {
+            src += ' ';
+            src += randomOperator(rng);
+            src += ' ';
+            src += std::to_string(1 + rng.below(1000));
+        }
+        src += " ;\n";
+        return src;
+    }
+
+    // 深层嵌套括号：a = ((((1 + 2) + 3) + 4) ...) ;
+    inline std::string nestedParens(std::size_t depth) {
+        std::string src = "a = ";
+        src.append(depth, '(');
+        src += "1";
+        for (std::size_t i = 0; i < depth; ++i) {
+            src += " + ";
+            src += std::to_string(i + 2);
+            src += ')';
+        }
+        src += " ;\n";
+        return src;
+    }
+
+    // 大量短语句：每行一条赋值
+    inline std::string manyStatements(std::size_t statements) {
+        Rng rng(2);
+        std::string src;
+        for (std::size_t i = 0; i < statements; ++i) {
+            src += identifier(i, 4);
+            src += " = ";
+            src += std::to_string(rng.below(100));
+            src += ' ';
+            src += randomOperator(rng);
+            src += ' ';
+            src += std::to_string(1 + rng.below(100));
+            src += " ;\n";
+        }
+        return src;
+    }
+
+    // 标识符密集：很长的变量名，运算数很短
+    inline std::string identifierHeavy(std::size_t statements) {
+        Rng rng(3);
+        std::string src;
+        for (std::size_t i = 0; i < statements; ++i) {
+            src += identifier(i, 48);
+            src += " = ";
+            src += std::to_string(rng.below(10));
+            src += " + ";
+            src += std::to_string(rng.below(10));
+            src += " ;\n";
+        }
+        return src;
+    }
+
+    // 空白密集：单词之间插入大量空格、制表符和空行
+    inline std::string whitespaceHeavy(std::size_t statements) {
+        Rng rng(4);
+        std::string src;
+        auto gap = [&]() {
+            std::size_t n = 8 + rng.below(32);
+            for (std::size_t k = 0; k < n; ++k) {
+                std::uint32_t r = rng.below(8);
+                src += r == 0 ? '\n' : (r < 3 ? '\t' : ' ');
+            }
+        };
+        for (std::size_t i = 0; i < statements; ++i) {
+            gap();
+            src += identifier(i, 4);
+            gap();
+            src += '=';
+            gap();
+            src += std::to_string(rng.below(100));
+            gap();
+            src += randomOperator(rng);
+            gap();
+            src += std::to_string(1 + rng.below(100));
+            gap();
+            src += ";\n";
+        }
+        return src;
+    }
+
+    // 条件语句密集：一半是可以改成 cmov/setcc 的简单条件赋值，一半是带语句块的分支
+    inline std::string conditionals(std::size_t statements) {
+        static const char* const comparisons[] = { "<", ">", "<=", ">=", "==", "!=" };
+        Rng rng(5);
+        std::string src;
+        for (std::size_t i = 0; i < statements; ++i) {
+            std::string target = identifier(i % 64, 4);
+            src += "if ( ";
+            src += identifier(rng.below(64), 4);
+            src += ' ';
+            src += comparisons[rng.below(6)];
+            src += ' ';
+            src += std::to_string(rng.below(100));
+            src += " ) ";
+            if (i % 2 == 0) {
+                src += target + " = " + std::to_string(rng.below(2)) + " ; else " + target + " = " + std::to_string(rng.below(100)) + " ;\n";
+            }
+            else {
+                src += "{ " + target + " = " + target + " + 1 ; t = " + std::to_string(rng.below(100)) + " ; } else " + target + " = 0 ;\n";
+            }
+        }
+        return src;
+    }
+
+    // 数组：先声明一组等长数组，再做逐元素运算和下标访问
+    inline std::string arrays(std::size_t statements) {
+        static const char* const ops[] = { "+", "-", "*", "/" };
+        const std::size_t count = 16;
+        Rng rng(6);
+        std::string src;
+        for (std::size_t i = 0; i < count; ++i) {
+            src += identifier(i, 4) + " = 1024[] ;\n";
+        }
+        src += "i = 7 ;\n";
+        for (std::size_t i = 0; i < statements; ++i) {
+            std::string target = identifier(rng.below(count), 4);
+            switch (rng.below(3)) {
+            case 0:
+                src += target + " = " + identifier(rng.below(count), 4) + ' ' + ops[rng.below(4)] + ' ' +
+                    identifier(rng.below(count), 4) + " * " + std::to_string(1 + rng.below(9)) + " ;\n";
+                break;
+            case 1:
+                src += target + " [ " + std::to_string(rng.below(1024)) + " ] = " + identifier(rng.below(count), 4) +
+                    " [ i ] + 1 ;\n";
+                break;
+            default:
+                src += "x = " + target + " [ i + " + std::to_string(rng.below(8)) + " ] ;\n";
+                break;
+            }
+        }
+        return src;
+    }
+
+    // 输出语句密集：字符串常量从一小组里反复选取（部分带转义），夹杂整数表达式的输出
+    inline std::string prints(std::size_t statements) {
+        const std::size_t messages = 32;
+        Rng rng(7);
+        std::string src = "n = 1 ;\n";
+        for (std::size_t i = 0; i < statements; ++i) {
+            std::size_t message = rng.below(messages);
+            if (rng.below(4) == 0) {
+                src += "print n * " + std::to_string(rng.below(100)) + " + 1 ;\n";
+            }
+            else if (message % 4 == 0) {
+                src += "print \"step " + std::to_string(message) + ":\\t\\\"done\\\"\\n\" ;\n";
+            }
+            else {
+                src += "print \"message number " + std::to_string(message) + " of the generated program\" ;\n";
+            }
+        }
+        return src;
+    }
+
+    struct Workload {
+        const char* name;
+        std::string source;
+    };
+
+    // 各阶段基准共用的一组输入
+    inline std::vector<Workload> standardWorkloads() {
+        return {
+            { "flat_chain_10k", flatChain(10000) },
+            { "nested_parens_1k", nestedParens(1000) },
+            { "many_statements_10k", manyStatements(10000) },
+            { "identifier_heavy_5k", identifierHeavy(5000) },
+            { "whitespace_heavy_5k", whitespaceHeavy(5000) },
+            { "conditionals_5k", conditionals(5000) },
+            { "arrays_5k", arrays(5000) },
+            { "prints_5k", prints(5000) },
+        };
+    }
+
+}
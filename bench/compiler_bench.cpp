@@ -0,0 +1,246 @@
+﻿// 编译器各阶段的基准测试：词法分析、语法分析、逆波兰式生成、汇编生成以及端到端流程
+//
+// 构建：cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target compiler_bench
+// 运行：
+//   ./build/bench/compiler_bench --out=bench.json [--filter=Lexer] [--min-time=0.5]
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AssemblyGenerator.h"
+#include "AstWalk.h"
+#include "BenchHarness.h"
+#include "Compiler.h"
+#include "Lexer.h"
+#include "LineIndex.h"
+#include "OutputBuffer.h"
+#include "Parser.h"
+#include "SemanticAnalyzer.h"
+#include "TokenBuffer.h"
+#include "Workloads.h"
+
+namespace {
+
+    // 各阶段的诊断信息收集到调用者的 diagnostics，不打印；每次运行前清空
+    void parseAll(const TokenBuffer<TokenCode>& tokens, Ast& ast, std::vector<std::string>& diagnostics) {
+        ast.clear();
+        Parser parser(tokens, ast);
+        parser.setDiagnostics(&diagnostics);
+        parser.parseProgram();
+    }
+
+    struct Prepared {
+        std::string source;
+        TokenBuffer<TokenCode> tokens;
+        Ast ast;
+        std::vector<std::string> rpnCode;
+        std::vector<std::string> diagnostics;
+    };
+
+    void prepare(const std::string& source, Prepared& p) {
+        p.source = source;
+        Lexer lexer(p.source);
+        lexer.tokenize(p.tokens);
+        parseAll(p.tokens, p.ast, p.diagnostics);
+        CodeGenContext context;
+        context.diagnostics = &p.diagnostics;
+        for (NodeId statement : p.ast.statements()) {
+            SemanticAnalyzer::generateCode(p.ast, statement, p.rpnCode, context);
+        }
+    }
+
+    void registerWorkload(const workloads::Workload& workload) {
+        // tokens 引用 source，因此 Prepared 建好后不能再移动
+        auto p = std::make_shared<Prepared>();
+        prepare(workload.source, *p);
+        const std::string suffix = std::string("/") + workload.name;
+
+        bench::add("Lexer::tokenize" + suffix, [p](bench::State& state) {
+            TokenBuffer<TokenCode> tokens;
+            while (state.keepRunning()) {
+                Lexer lexer(p->source);
+                lexer.tokenize(tokens);
+                bench::doNotOptimize(tokens.kinds());
+            }
+            state.setBytesProcessed(p->source.size());
+            state.setItemsProcessed(p->tokens.size());
+        });
+
+        // 建立换行索引并换算每个单词的行列号，出错时才会走到这里
+        bench::add("LineIndex::locate" + suffix, [p](bench::State& state) {
+            while (state.keepRunning()) {
+                LineIndex lines(p->source);
+                int sum = 0;
+                for (std::size_t i = 0; i < p->tokens.size(); ++i) {
+                    sum += lines.locate(p->tokens.offset(i)).column;
+                }
+                bench::doNotOptimize(sum);
+            }
+            state.setBytesProcessed(p->source.size());
+            state.setItemsProcessed(p->tokens.size());
+        });
+
+        bench::add("Parser::parse" + suffix, [p](bench::State& state) {
+            Ast ast;
+            std::vector<std::string> diagnostics;
+            while (state.keepRunning()) {
+                diagnostics.clear();
+                parseAll(p->tokens, ast, diagnostics);
+                bench::doNotOptimize(ast.statements().data());
+            }
+            state.setItemsProcessed(p->tokens.size());
+        });
+
+        bench::add("SemanticAnalyzer::generateCode" + suffix, [p](bench::State& state) {
+            std::vector<std::string> code;
+            std::vector<std::string> diagnostics;
+            while (state.keepRunning()) {
+                code.clear();
+                diagnostics.clear();
+                CodeGenContext context;
+                context.diagnostics = &diagnostics;
+                for (NodeId statement : p->ast.statements()) {
+                    SemanticAnalyzer::generateCode(p->ast, statement, code, context);
+                }
+                bench::doNotOptimize(code.data());
+            }
+            state.setItemsProcessed(p->ast.statements().size());
+        });
+
+        // 数据流分析会改写语法树，每次都要重新解析；减去 Parser::parse 就是两遍分析的开销
+        bench::add("Parser::parse+Dataflow" + suffix, [p](bench::State& state) {
+            Ast ast;
+            SymbolTable symbols;
+            std::vector<std::string> diagnostics;
+            while (state.keepRunning()) {
+                diagnostics.clear();
+                parseAll(p->tokens, ast, diagnostics);
+                symbols.clear();
+                SemanticAnalyzer::checkAssignments(ast, symbols, &diagnostics);
+                bench::doNotOptimize(SemanticAnalyzer::eliminateDeadAssignments(ast, symbols));
+            }
+            state.setItemsProcessed(p->tokens.size());
+        });
+
+        // 遍历框架本身的开销：一次完整的先序遍历和一次带深度统计的遍历
+        bench::add("AstWalk" + suffix, [p](bench::State& state) {
+            while (state.keepRunning()) {
+                std::size_t nodes = 0;
+                for (NodeId statement : p->ast.statements()) {
+                    walkPreOrder(p->ast, statement, [&](NodeId, const AstNode&) { nodes++; });
+                    nodes += SemanticAnalyzer::analyze(p->ast, statement).maxDepth;
+                }
+                bench::doNotOptimize(nodes);
+            }
+            state.setItemsProcessed(p->ast.nodeCount());
+        });
+
+        bench::add("convertToAssembly" + suffix, [p](bench::State& state) {
+            std::size_t bytes = 0;
+            for (const std::string& code : p->rpnCode) {
+                bytes += code.size();
+            }
+            OutputBuffer assembly;
+            while (state.keepRunning()) {
+                assembly.clear();
+                for (const std::string& code : p->rpnCode) {
+                    convertToAssembly(code, assembly);
+                }
+                bench::doNotOptimize(assembly.view().data());
+            }
+            state.setBytesProcessed(bytes);
+        });
+
+        // 不做窥孔优化，与上面对比可以看出优化本身的开销
+        bench::add("convertToAssembly(no peephole)" + suffix, [p](bench::State& state) {
+            std::size_t bytes = 0;
+            for (const std::string& code : p->rpnCode) {
+                bytes += code.size();
+            }
+            OutputBuffer assembly;
+            while (state.keepRunning()) {
+                assembly.clear();
+                for (const std::string& code : p->rpnCode) {
+                    convertToAssembly(code, assembly, false);
+                }
+                bench::doNotOptimize(assembly.view().data());
+            }
+            state.setBytesProcessed(bytes);
+        });
+
+        // 端到端：各阶段之间直接在内存中传递单词和语法树
+        bench::add("EndToEnd" + suffix, [p](bench::State& state) {
+            TokenBuffer<TokenCode> tokens;
+            Ast ast;
+            std::vector<std::string> code;
+            OutputBuffer assembly;
+            std::vector<std::string> diagnostics;
+            while (state.keepRunning()) {
+                Lexer lexer(p->source);
+                lexer.tokenize(tokens);
+                diagnostics.clear();
+                parseAll(tokens, ast, diagnostics);
+                code.clear();
+                assembly.clear();
+                CodeGenContext context;
+                context.diagnostics = &diagnostics;
+                for (NodeId statement : ast.statements()) {
+                    SemanticAnalyzer::generateCode(ast, statement, code, context);
+                }
+                for (const std::string& line : code) {
+                    convertToAssembly(line, assembly);
+                }
+                bench::doNotOptimize(assembly.view().data());
+            }
+            state.setBytesProcessed(p->source.size());
+        });
+
+        // 嵌入式接口：同一个 CompilerContext 反复编译，缓冲区在调用之间复用。
+        // 流水线模式不做死代码删除，这里也关掉，两者比较的是同样的工作
+        bench::add("CompilerContext::compile" + suffix, [p](bench::State& state) {
+            CompilerContext context;
+            CompileOptions options;
+            options.eliminateDeadAssignments = false;
+            while (state.keepRunning()) {
+                const CompileResult& result = context.compile(p->source, options);
+                bench::doNotOptimize(result.assembly.view().data());
+            }
+            state.setBytesProcessed(p->source.size());
+        });
+
+        // 流水线模式：词法、语法、代码生成在三个线程上重叠执行
+        bench::add("CompilerContext::compile(pipelined)" + suffix, [p](bench::State& state) {
+            CompilerContext context;
+            CompileOptions options;
+            options.pipelined = true;
+            options.eliminateDeadAssignments = false;
+            while (state.keepRunning()) {
+                const CompileResult& result = context.compile(p->source, options);
+                bench::doNotOptimize(result.assembly.view().data());
+            }
+            state.setBytesProcessed(p->source.size());
+        });
+
+        // 默认选项：包括数据流分析和死代码删除，减去 CompilerContext::compile 就是这两遍的开销
+        bench::add("CompilerContext::compile(eliminateDeadAssignments)" + suffix, [p](bench::State& state) {
+            CompilerContext context;
+            CompileOptions options;
+            options.eliminateDeadAssignments = true;
+            options.keepFinalValues = true;
+            while (state.keepRunning()) {
+                const CompileResult& result = context.compile(p->source, options);
+                bench::doNotOptimize(result.assembly.view().data());
+            }
+            state.setBytesProcessed(p->source.size());
+        });
+    }
+
+}
+
+int main(int argc, char** argv) {
+    for (const workloads::Workload& workload : workloads::standardWorkloads()) {
+        registerWorkload(workload);
+    }
+
+    return bench::runAll(argc, argv);
+}
@@ -0,0 +1,261 @@
+﻿#include "AST.h"
+#include "AstWalk.h"
+
+NodeId Ast::add(const AstNode& node) {
+    nodes_.push_back(node);
+    return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+void Ast::setName(AstNode& node, std::string_view name) {
+    node.nameOffset = static_cast<std::uint32_t>(names_.size());
+    node.nameLength = static_cast<std::uint32_t>(name.size());
+    names_.append(name.data(), name.size());
+}
+
+NodeId Ast::addInt(std::int32_t value) {
+    AstNode node{ NodeKind::Int };
+    node.value = value;
+    return add(node);
+}
+
+NodeId Ast::addVariable(std::string_view name) {
+    AstNode node{ NodeKind::Variable };
+    setName(node, name);
+    return add(node);
+}
+
+NodeId Ast::addBinaryOp(char op, NodeId left, NodeId right) {
+    AstNode node{ NodeKind::BinaryOp };
+    node.op = op;
+    node.children[0] = left;
+    node.children[1] = right;
+    return add(node);
+}
+
+NodeId Ast::addAssignment(std::string_view name, NodeId expression) {
+    AstNode node{ NodeKind::Assignment };
+    setName(node, name);
+    node.children[0] = expression;
+    return add(node);
+}
+
+NodeId Ast::addIfElse(NodeId condition, NodeId ifBranch, NodeId elseBranch) {
+    AstNode node{ NodeKind::IfElse };
+    node.children[0] = condition;
+    node.children[1] = ifBranch;
+    node.children[2] = elseBranch;
+    return add(node);
+}
+
+NodeId Ast::addArrayNew(std::int32_t length) {
+    AstNode node{ NodeKind::ArrayNew };
+    node.value = length;
+    return add(node);
+}
+
+NodeId Ast::addIndex(std::string_view name, NodeId index) {
+    AstNode node{ NodeKind::Index };
+    setName(node, name);
+    node.children[0] = index;
+    return add(node);
+}
+
+NodeId Ast::addStore(std::string_view name, NodeId index, NodeId value) {
+    AstNode node{ NodeKind::Store };
+    setName(node, name);
+    node.children[0] = index;
+    node.children[1] = value;
+    return add(node);
+}
+
+NodeId Ast::addString(std::uint32_t literal) {
+    AstNode node{ NodeKind::String };
+    node.value = static_cast<std::int32_t>(literal);
+    return add(node);
+}
+
+NodeId Ast::addPrint(NodeId value) {
+    AstNode node{ NodeKind::Print };
+    node.children[0] = value;
+    return add(node);
+}
+
+NodeId Ast::addBlock(const std::vector<NodeId>& statements) {
+    // 从后往前建立，每个节点指向块中其余的语句
+    NodeId rest = kNoNode;
+    for (std::size_t i = statements.size(); i-- > 0;) {
+        AstNode node{ NodeKind::Block };
+        node.children[0] = statements[i];
+        node.children[1] = rest;
+        rest = add(node);
+    }
+    if (rest == kNoNode) {
+        rest = add(AstNode{ NodeKind::Block });  // 空块
+    }
+    nodes_[rest].op = '{';
+    return rest;
+}
+
+void Ast::append(const Ast& other) {
+    NodeId nodeBase = static_cast<NodeId>(nodes_.size());
+    std::uint32_t nameBase = static_cast<std::uint32_t>(names_.size());
+    std::vector<std::uint32_t> literals;
+    if (!other.strings_.empty()) {
+        literals = strings_.merge(other.strings_);
+    }
+    nodes_.reserve(nodes_.size() + other.nodes_.size());
+    for (AstNode node : other.nodes_) {
+        node.nameOffset += nameBase;
+        if (node.kind == NodeKind::String && !literals.empty()) {
+            node.value = static_cast<std::int32_t>(literals[node.value]);
+        }
+        for (NodeId& child : node.children) {
+            if (child != kNoNode) {
+                child += nodeBase;
+            }
+        }
+        nodes_.push_back(node);
+    }
+    names_ += other.names_;
+    for (NodeId statement : other.statements_) {
+        statements_.push_back(statement + nodeBase);
+    }
+}
+
+void Ast::clear() {
+    nodes_.clear();
+    names_.clear();
+    statements_.clear();
+    strings_.clear();
+}
+
+std::string_view operatorText(char op) {
+    switch (op) {
+    case '+':
+        return "+";
+    case '-':
+        return "-";
+    case '*':
+        return "*";
+    case '/':
+        return "/";
+    case kOpLess:
+        return "<";
+    case kOpGreater:
+        return ">";
+    case kOpLessEqual:
+        return "<=";
+    case kOpGreaterEqual:
+        return ">=";
+    case kOpEqual:
+        return "==";
+    case kOpNotEqual:
+        return "!=";
+    default:
+        return "?";
+    }
+}
+
+char operatorFromText(std::string_view text) {
+    static const char ops[] = { '+', '-', '*', '/', kOpLess, kOpGreater, kOpLessEqual, kOpGreaterEqual, kOpEqual, kOpNotEqual };
+    for (char op : ops) {
+        if (operatorText(op) == text) {
+            return op;
+        }
+    }
+    return 0;
+}
+
+namespace {
+    // 中序输出：a = 1 + 2
+    struct AstPrinter {
+        const Ast& ast;
+        OutputBuffer& out;
+
+        bool enter(NodeId, const AstNode& node) {
+            switch (node.kind) {
+            case NodeKind::Int:
+                out << node.value;
+                break;
+            case NodeKind::Variable:
+                out << ast.name(node);
+                break;
+            case NodeKind::Assignment:
+                out << ast.name(node) << " = ";
+                break;
+            case NodeKind::IfElse:
+                out << "If-else\nCondition: ";
+                break;
+            case NodeKind::Block:
+                if (node.op == '{') {
+                    out << "{ ";
+                }
+                break;
+            case NodeKind::ArrayNew:
+                out << node.value << "[]";
+                break;
+            case NodeKind::Index:
+            case NodeKind::Store:
+                out << ast.name(node) << " [ ";
+                break;
+            case NodeKind::String:
+                out << '"' << ast.strings().literal(static_cast<std::uint32_t>(node.value)) << '"';
+                break;
+            case NodeKind::Print:
+                out << "print ";
+                break;
+            default:
+                break;
+            }
+            return true;
+        }
+
+        void between(NodeId, const AstNode& node, int index) {
+            if (node.kind == NodeKind::BinaryOp) {
+                out << ' ' << operatorText(node.op) << ' ';
+            }
+            else if (node.kind == NodeKind::Block) {
+                out << " ; ";
+            }
+            else if (node.kind == NodeKind::Store) {
+                out << " ] = ";
+            }
+            else if (node.kind == NodeKind::IfElse) {
+                out << (index == 1 ? "\nIf branch: " : "\nElse branch: ");
+            }
+        }
+
+        void leave(NodeId, const AstNode& node) {
+            if (node.kind == NodeKind::IfElse) {
+                out << '\n';
+            }
+            else if (node.kind == NodeKind::Index) {
+                out << " ]";
+            }
+            else if (node.kind == NodeKind::Block) {
+                // 块中最后一条语句之后补上分号，第一个节点最后离开，负责右括号
+                if (node.children[0] != kNoNode && node.children[1] == kNoNode) {
+                    out << " ;";
+                }
+                if (node.op == '{') {
+                    out << (node.children[0] == kNoNode ? "}" : " }");
+                }
+            }
+        }
+    };
+}
+
+void printAst(const Ast& ast, NodeId root, OutputBuffer& out) {
+    AstPrinter printer{ ast, out };
+    walk(ast, root, printer);
+}
+
+std::string astToString(const Ast& ast, NodeId root) {
+    if (root == kNoNode) {
+        return "";
+    }
+
+    OutputBuffer out;
+    printAst(ast, root, out);
+    return std::string(out.view());
+}
@@ -0,0 +1,131 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "OutputBuffer.h"
+#include "StringPool.h"
+
+// 抽象语法树
+//
+// 节点按种别打标签，统一存放在 Ast 的节点池中，子节点用下标（NodeId）引用。
+// 语法树上的各种操作（打印、逆波兰式、常量折叠、分析）都通过 AstWalk.h 中的遍历框架完成，
+// 不再为每种节点写虚函数；遍历使用显式栈，很深的树也不会耗尽调用栈。
+// Ast::clear 保留节点池的容量，同一个 Ast 可以在多次编译之间复用。
+
+enum class NodeKind : std::uint8_t {
+    Int,         // 整数
+    Variable,    // 变量引用
+    BinaryOp,    // 二元运算：children[0] 左操作数，children[1] 右操作数
+    Assignment,  // 赋值：children[0] 为右侧表达式
+    IfElse,      // 条件：children[0] 条件，children[1] if 分支，children[2] else 分支（可以为空）
+    Block,       // 语句块 { ... }：children[0] 一条语句，children[1] 块中其余语句（下一个 Block 节点）
+    ArrayNew,    // 数组声明 a = N[] 的右侧，value 为元素个数
+    Index,       // 取数组元素 a[i]：children[0] 为下标
+    Store,       // 给数组元素赋值 a[i] = v：children[0] 下标，children[1] 右侧表达式
+    String,      // 字符串常量，value 为 Ast::strings() 中的下标
+    Print        // print 语句：children[0] 为要输出的字符串常量或整数表达式
+};
+
+// BinaryOp 节点中比较运算符的编码；算术运算符直接使用字符本身
+constexpr char kOpLess = '<';
+constexpr char kOpGreater = '>';
+constexpr char kOpLessEqual = 'l';
+constexpr char kOpGreaterEqual = 'g';
+constexpr char kOpEqual = 'e';
+constexpr char kOpNotEqual = 'n';
+
+// 运算符的源程序写法，例如 kOpLessEqual 对应 "<="
+std::string_view operatorText(char op);
+
+// 由源程序写法得到节点中的编码，不是运算符时返回 0
+char operatorFromText(std::string_view text);
+
+inline bool isComparison(char op) {
+    return op == kOpLess || op == kOpGreater || op == kOpLessEqual ||
+        op == kOpGreaterEqual || op == kOpEqual || op == kOpNotEqual;
+}
+
+using NodeId = std::uint32_t;
+constexpr NodeId kNoNode = 0xffffffffu;
+
+struct AstNode {
+    NodeKind kind;
+    char op = 0;                   // BinaryOp 的运算符；块的第一个 Block 节点为 '{'
+
+    std::int32_t value = 0;        // Int 的值，ArrayNew 的元素个数，String 的常量下标
+    std::uint32_t nameOffset = 0;  // Variable / Assignment / Index / Store 的变量名在名字池中的位置
+    std::uint32_t nameLength = 0;
+    NodeId children[3] = { kNoNode, kNoNode, kNoNode };
+
+    int childCount() const {
+        switch (kind) {
+        case NodeKind::BinaryOp:
+        case NodeKind::Block:
+        case NodeKind::Store:
+            return 2;
+        case NodeKind::Assignment:
+        case NodeKind::Index:
+        case NodeKind::Print:
+            return 1;
+        case NodeKind::IfElse:
+            return 3;
+        default:
+            return 0;
+        }
+    }
+};
+
+class Ast {
+public:
+    NodeId addInt(std::int32_t value);
+    NodeId addVariable(std::string_view name);
+    NodeId addBinaryOp(char op, NodeId left, NodeId right);
+    NodeId addAssignment(std::string_view name, NodeId expression);
+    NodeId addIfElse(NodeId condition, NodeId ifBranch, NodeId elseBranch);
+    NodeId addArrayNew(std::int32_t length);
+    NodeId addIndex(std::string_view name, NodeId index);
+    NodeId addStore(std::string_view name, NodeId index, NodeId value);
+    NodeId addString(std::uint32_t literal);
+    NodeId addPrint(NodeId value);
+    // statements 中的语句依次串成 Block 节点，返回块的第一个节点
+    NodeId addBlock(const std::vector<NodeId>& statements);
+
+    const AstNode& node(NodeId id) const { return nodes_[id]; }
+    AstNode& node(NodeId id) { return nodes_[id]; }
+    std::size_t nodeCount() const { return nodes_.size(); }
+
+    std::string_view name(const AstNode& node) const {
+        return std::string_view(names_.data() + node.nameOffset, node.nameLength);
+    }
+
+    // 字符串常量池，String 节点按下标引用
+    StringPool& strings() { return strings_; }
+    const StringPool& strings() const { return strings_; }
+
+    // 每条语句一棵树，按源程序顺序排列
+    std::vector<NodeId>& statements() { return statements_; }
+    const std::vector<NodeId>& statements() const { return statements_; }
+
+    // 把 other 的节点和语句接到后面，子节点编号与名字位置随之平移；
+    // other 有自己的字符串常量时并入常量池，String 节点改用合并后的下标
+    void append(const Ast& other);
+
+    // 清空节点但保留容量
+    void clear();
+
+private:
+    NodeId add(const AstNode& node);
+    void setName(AstNode& node, std::string_view name);
+
+    std::vector<AstNode> nodes_;
+    std::string names_;
+    std::vector<NodeId> statements_;
+    StringPool strings_;
+};
+
+// 输出语法树文本（output_ABT.txt 的格式）
+void printAst(const Ast& ast, NodeId root, OutputBuffer& out);
+
+// 语法树文本，空树返回空串
+std::string astToString(const Ast& ast, NodeId root);
@@ -0,0 +1,870 @@
+﻿#include "AssemblyGenerator.h"
+#include <cctype>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "SemanticAnalyzer.h"
+
+namespace {
+    // 翻译过程中的值
+    //   Operand：还没有生成代码的操作数（整数、变量、标号或常量下标的数组元素）
+    //   Stack：已经压在机器栈上
+    //   Compare：还没有求值的比较 text cc right；onStack 时两个操作数都已压栈
+    //   Array：N array，text 为元素个数
+    enum class ValueKind { Operand, Stack, Compare, Array };
+
+    struct Value {
+        ValueKind kind = ValueKind::Operand;
+        std::string text{};
+        std::string right{};
+        const char* cc = nullptr;
+        bool onStack = false;
+    };
+
+    // 逐元素循环中的向量值：所在的 xmm 寄存器，hoisted 表示循环外广播好的标量，不能被改写
+    struct VectorValue {
+        int reg;
+        bool hoisted;
+    };
+
+    const char* vectorInstruction(char op) {
+        switch (op) {
+        case '+':
+            return "paddd";
+        case '-':
+            return "psubd";
+        case '*':
+            return "pmulld";
+        default:
+            return nullptr;
+        }
+    }
+
+    bool isNumber(std::string_view text) {
+        return !text.empty() && std::isdigit(static_cast<unsigned char>(text[0]));
+    }
+
+    // 逆波兰式中的变量 @a 在汇编中叫 v_a。变量名里没有下划线，
+    // 所以它不会和寄存器（rcx、xmm0）、str_N 或 bounds_error 重名
+    std::string symbol(std::string_view token) {
+        if (!token.empty() && token.front() == kRpnVariable) {
+            return "v_" + std::string(token.substr(1));
+        }
+        return std::string(token);
+    }
+
+    // 整个数组的引用 @a[]
+    bool isArrayOperand(std::string_view token) {
+        return token.size() > 2 && token.compare(token.size() - 2, 2, "[]") == 0;
+    }
+
+    // 数组的存储，元素个数补齐到 4 的倍数
+    struct ArrayStorage {
+        std::string name;
+        std::size_t length;
+    };
+
+    std::size_t paddedLength(std::size_t length) {
+        return (length + 3) / 4 * 4;
+    }
+
+    // 基本块：标号、顺序执行的指令和结尾的跳转
+    struct BasicBlock {
+        std::string label{};
+        InstructionList body{};
+        Instruction terminator{};
+    };
+
+    const char* conditionCode(std::string_view op) {
+        if (op == "<") return "l";
+        if (op == ">") return "g";
+        if (op == "<=") return "le";
+        if (op == ">=") return "ge";
+        if (op == "==") return "e";
+        if (op == "!=") return "ne";
+        return nullptr;
+    }
+
+    // 条件不成立时的条件码
+    const char* inverse(const char* cc) {
+        std::string_view code(cc);
+        if (code == "l") return "ge";
+        if (code == "ge") return "l";
+        if (code == "g") return "le";
+        if (code == "le") return "g";
+        if (code == "e") return "ne";
+        return "e";
+    }
+
+    const char* arithmetic(char op) {
+        switch (op) {
+        case '+':
+            return "add";
+        case '-':
+            return "sub";
+        case '*':
+            return "mul";
+        case '/':
+            return "div";
+        default:
+            return nullptr;
+        }
+    }
+
+    std::string xmm(int reg) {
+        return "xmm" + std::to_string(reg);
+    }
+
+    // 常量池第 id 个字符串的标号；变量名里没有下划线，不会重名
+    std::string stringLabel(std::string_view id) {
+        return "str_" + std::string(id);
+    }
+
+    // 先按栈式机器生成代码：运算的操作数都在机器栈上，结果也压回栈上。
+    // 寄存器形式留给窥孔优化去改写
+    class Translator {
+    public:
+        Translator() : blocks_(1) {}
+
+        void translate(std::string_view expression) {
+            std::size_t pos = 0;
+            while (pos < expression.size()) {
+                std::size_t end = expression.find_first_of(" \t\r\n", pos);
+                if (end == std::string_view::npos) {
+                    end = expression.size();
+                }
+                if (end > pos) {
+                    word(expression.substr(pos, end - pos));
+                }
+                pos = end + 1;
+            }
+
+            // 剩下的值作为表达式的结果留在栈上
+            spill();
+            stack_.clear();
+        }
+
+        void optimize(const PeepholeOptimizer& optimizer, PeepholeStats* stats) {
+            for (BasicBlock& block : blocks_) {
+                optimizer.optimize(block.body, stats);
+            }
+        }
+
+        void write(OutputBuffer& out) const {
+            for (std::size_t i = 0; i < blocks_.size(); ++i) {
+                const BasicBlock& block = blocks_[i];
+                if (!block.label.empty()) {
+                    out << block.label << ":\n";
+                }
+                for (const Instruction& instruction : block.body) {
+                    instruction.write(out);
+                }
+                if (!block.terminator.op.empty() && !jumpsToNext(i)) {
+                    block.terminator.write(out);
+                }
+            }
+            // 数组存储放在代码之后；元素个数补齐到 4 的倍数，逐元素循环不需要处理剩余元素
+            for (const ArrayStorage& array : arrays_) {
+                out << "align 16\n" << array.name << ": times " << paddedLength(array.length) << " dd 0\n";
+            }
+        }
+
+        const std::vector<BasicBlock>& blocks() const { return blocks_; }
+        const std::vector<ArrayStorage>& arrays() const { return arrays_; }
+
+        // 无条件跳转的目标紧跟在后面（中间只隔着空块）时可以省掉
+        bool jumpsToNext(std::size_t index) const {
+            const Instruction& terminator = blocks_[index].terminator;
+            if (!terminator.is("jmp")) {
+                return false;
+            }
+            for (std::size_t i = index + 1; i < blocks_.size(); ++i) {
+                if (blocks_[i].label == terminator.operands[0]) {
+                    return true;
+                }
+                if (!blocks_[i].body.empty() || !blocks_[i].terminator.op.empty()) {
+                    break;
+                }
+            }
+            return false;
+        }
+
+    private:
+        void word(std::string_view token) {
+            if (recording_) {
+                // 逐元素赋值的内容先记下来，到 endvec 时一起生成循环
+                if (token == "endvec") {
+                    recording_ = false;
+                    vectorLoop();
+                }
+                else {
+                    recorded_.push_back(token);
+                }
+            }
+            else if (token.front() == kRpnVariable) {
+                // 变量先于所有操作判断，变量名不会被当成操作或标号
+                stack_.push_back({ ValueKind::Operand, symbol(token) });
+            }
+            else if (token == "vec") {
+                vectorLength_ = std::stoul(pop().text);
+                vectorLabel_ = pop().text;
+                recorded_.clear();
+                recording_ = true;
+            }
+            else if (token == "array") {
+                Value length = pop();
+                length.kind = ValueKind::Array;
+                stack_.push_back(std::move(length));
+            }
+            else if (token.front() == '[') {
+                element(token);
+            }
+            else if (token == "=") {
+                std::string name = pop().text;
+                if (!stack_.empty() && stack_.back().kind == ValueKind::Array) {
+                    declareArray(name, std::stoul(pop().text));
+                    return;
+                }
+                spill();
+                pop();
+                emit("pop", name);
+            }
+            else if (token.size() == 1 && arithmetic(token[0])) {
+                spill();
+                pop();
+                pop();
+                emit(arithmetic(token[0]));
+                stack_.push_back({ ValueKind::Stack });
+            }
+            else if (const char* cc = conditionCode(token)) {
+                // 比较先留在栈上，由使用它的跳转或 select 决定生成什么指令
+                std::size_t size = stack_.size();
+                bool symbolic = size >= 2 &&
+                    stack_[size - 2].kind == ValueKind::Operand && stack_[size - 1].kind == ValueKind::Operand;
+                if (!symbolic) {
+                    spill();
+                }
+                Value right = pop();
+                Value left = pop();
+                stack_.push_back({ ValueKind::Compare, std::move(left.text), std::move(right.text), cc, !symbolic });
+            }
+            else if (token == "jz") {
+                std::string label = pop().text;
+                const char* cc = compare(pop());
+                endBlock(Instruction(std::string("j") + inverse(cc), label));
+            }
+            else if (token == "jmp") {
+                endBlock(Instruction("jmp", pop().text));
+            }
+            else if (token == "select") {
+                select();
+            }
+            else if (token == "print") {
+                print();
+            }
+            else if (token.front() == '.' && token.back() == ':') {
+                // 标号 .Lk: 开始一个新的基本块
+                blocks_.push_back({ std::string(token.substr(0, token.size() - 1)) });
+            }
+            else {
+                // 整数、字符串常量或标号
+                stack_.push_back({ ValueKind::Operand, std::string(token) });
+            }
+        }
+
+        // cond T E select：T、E 在栈上时先弹到 r8d、r9d，比较之后用 setcc 或 cmov 选出结果
+        void select() {
+            std::size_t size = stack_.size();
+            if (size >= 2 && (stack_[size - 1].kind == ValueKind::Compare || stack_[size - 2].kind == ValueKind::Compare)) {
+                spill();
+            }
+            Value elseValue = pop();
+            Value thenValue = pop();
+            std::string elseOperand = operand(elseValue, "r9d");
+            std::string thenOperand = operand(thenValue, "r8d");
+            const char* cc = compare(pop());
+            if (thenOperand == "1" && elseOperand == "0") {
+                emit("set" + std::string(cc), "al");
+                emit("movzx", "eax", "al");
+            }
+            else if (thenOperand == "0" && elseOperand == "1") {
+                emit("set" + std::string(inverse(cc)), "al");
+                emit("movzx", "eax", "al");
+            }
+            else {
+                emit("mov", "eax", elseOperand);
+                emit("mov", "edx", thenOperand);
+                emit("cmov" + std::string(cc), "eax", "edx");
+            }
+            emit("push", "eax");
+            stack_.push_back({ ValueKind::Stack });
+        }
+
+        // 字符串常量把地址传给 print_string，整数值传给 print_int（运行时库提供）
+        void print() {
+            if (!stack_.empty() && stack_.back().kind == ValueKind::Operand && stack_.back().text.front() == '$') {
+                emit("lea", "rdi", "[" + stringLabel(pop().text.substr(1)) + "]");
+                emit("call", "print_string");
+                return;
+            }
+            spill();
+            pop();
+            emit("pop", "edi");
+            emit("call", "print_int");
+        }
+
+        void declareArray(const std::string& name, std::size_t length) {
+            arrays_.push_back({ name, length });
+        }
+
+        // 取数组元素 [] / [N]，给数组元素赋值 []= / [N]=；N 是需要在运行时检查的上界
+        void element(std::string_view token) {
+            bool store = token.back() == '=';
+            std::string bound(token.substr(1, token.find(']') - 1));
+            std::string name = pop().text;
+            if (stack_.size() < (store ? 2u : 1u)) {
+                return;
+            }
+            std::size_t indexAt = stack_.size() - (store ? 2 : 1);
+            const Value& index = stack_[indexAt];
+
+            if (index.kind == ValueKind::Operand && isNumber(index.text)) {
+                // 常量下标已在编译时检查过
+                std::size_t offset = std::stoul(index.text) * 4;
+                std::string address = offset == 0 ? "dword [" + name + "]" : "dword [" + name + " + " + std::to_string(offset) + "]";
+                stack_.erase(stack_.begin() + indexAt);
+                if (store) {
+                    spill();
+                    pop();
+                    emit("pop", address);
+                }
+                else {
+                    stack_.push_back({ ValueKind::Operand, std::move(address) });
+                }
+                return;
+            }
+
+            spill();
+            if (store) {
+                pop();
+                emit("pop", "eax");
+            }
+            pop();
+            emit("pop", "ecx");
+            if (!bound.empty()) {
+                emit("cmp", "ecx", bound);
+                endBlock(Instruction("jae", "bounds_error"));
+            }
+            std::string address = "dword [" + name + " + rcx*4]";
+            if (store) {
+                emit("mov", address, "eax");
+            }
+            else {
+                // rcx 会被后面的下标改写，先把元素压栈
+                emit("push", address);
+                stack_.push_back({ ValueKind::Stack });
+            }
+        }
+
+        void broadcast(std::string_view scalar, int reg) {
+            emit("mov", "eax", symbol(scalar));
+            emit("movd", xmm(reg), "eax");
+            emit("pshufd", xmm(reg), xmm(reg), "0");
+        }
+
+        // 用 SSE4.1 每次处理 4 个 32 位元素。标量操作数在循环前广播到 xmm8~xmm15，
+        // 循环内的值按栈深度使用 xmm0~xmm7。下标只在 [0, 元素个数) 内变化，不需要边界检查
+        void vectorLoop() {
+            for (std::string_view token : recorded_) {
+                if (token == "/") {
+                    scalarLoop();
+                    return;
+                }
+            }
+            std::size_t padded = paddedLength(vectorLength_);
+            std::vector<std::pair<std::string_view, int>> hoisted;
+            int nextHoisted = 15;
+            for (std::size_t i = 0; i < recorded_.size(); ++i) {
+                std::string_view token = recorded_[i];
+                bool scalar = token != "=" && !isArrayOperand(token) &&
+                    !(token.size() == 1 && arithmetic(token[0]));
+                if (!scalar || nextHoisted < 8) {
+                    continue;
+                }
+                bool seen = false;
+                for (const auto& entry : hoisted) {
+                    seen = seen || entry.first == token;
+                }
+                if (!seen) {
+                    broadcast(token, nextHoisted);
+                    hoisted.push_back({ token, nextHoisted-- });
+                }
+            }
+            emit("xor", "ecx", "ecx");
+            blocks_.push_back({ vectorLabel_ });
+
+            std::vector<VectorValue> values;
+            for (std::size_t i = 0; i < recorded_.size(); ++i) {
+                std::string_view token = recorded_[i];
+                int depth = static_cast<int>(values.size());
+                if (isArrayOperand(token)) {
+                    std::string address = "[" + symbol(token.substr(0, token.size() - 2)) + " + rcx*4]";
+                    if (i + 1 < recorded_.size() && recorded_[i + 1] == "=") {
+                        // 赋值目标
+                        VectorValue value = values.back();
+                        values.pop_back();
+                        emit("movdqu", address, xmm(value.reg));
+                        ++i;
+                    }
+                    else {
+                        emit("movdqu", xmm(depth), address);
+                        values.push_back({ depth, false });
+                    }
+                }
+                else if (token.size() == 1 && arithmetic(token[0])) {
+                    VectorValue right = values.back();
+                    values.pop_back();
+                    VectorValue left = values.back();
+                    values.pop_back();
+                    int target = depth - 2;
+                    if (left.hoisted) {
+                        emit("movdqa", xmm(target), xmm(left.reg));
+                    }
+                    emit(vectorInstruction(token[0]), xmm(target), xmm(right.reg));
+                    values.push_back({ target, false });
+                }
+                else {
+                    // 标量：使用循环外广播好的寄存器，寄存器不够时在循环内广播
+                    int reg = -1;
+                    for (const auto& entry : hoisted) {
+                        if (entry.first == token) {
+                            reg = entry.second;
+                        }
+                    }
+                    if (reg >= 0) {
+                        values.push_back({ reg, true });
+                    }
+                    else {
+                        broadcast(token, depth);
+                        values.push_back({ depth, false });
+                    }
+                }
+            }
+            emit("add", "rcx", "4");
+            emit("cmp", "rcx", std::to_string(padded));
+            endBlock(Instruction("jb", vectorLabel_));
+        }
+
+        // 含除法的逐元素赋值：SIMD 没有整数除法，逐个元素生成与标量表达式相同的栈式代码，
+        // 除数为 0 时和标量除法一样出错。只循环真正的元素个数，补齐的元素是 0，不能拿来做除数。
+        // 栈式除法和窥孔优化都会用到 ecx，下标改用 rsi
+        void scalarLoop() {
+            emit("xor", "esi", "esi");
+            blocks_.push_back({ vectorLabel_ });
+            for (std::size_t i = 0; i < recorded_.size(); ++i) {
+                std::string_view token = recorded_[i];
+                if (isArrayOperand(token)) {
+                    std::string address = "dword [" + symbol(token.substr(0, token.size() - 2)) + " + rsi*4]";
+                    if (i + 1 < recorded_.size() && recorded_[i + 1] == "=") {
+                        // 赋值目标
+                        emit("pop", address);
+                        ++i;
+                    }
+                    else {
+                        emit("push", address);
+                    }
+                }
+                else if (token.size() == 1 && arithmetic(token[0])) {
+                    emit(arithmetic(token[0]));
+                }
+                else {
+                    emit("push", symbol(token));
+                }
+            }
+            emit("add", "rsi", "1");
+            emit("cmp", "rsi", std::to_string(vectorLength_));
+            endBlock(Instruction("jb", vectorLabel_));
+        }
+
+        // 操作数不够说明逆波兰式有错，继续翻译只会弹出没有压过的值
+        Value pop() {
+            if (stack_.empty()) {
+                throw std::runtime_error("Malformed RPN: stack underflow");
+            }
+            Value value = std::move(stack_.back());
+            stack_.pop_back();
+            return value;
+        }
+
+        // 把值压到机器栈上；比较用 setcc 转成 0 或 1
+        void push(Value& value) {
+            if (value.kind == ValueKind::Operand) {
+                emit("push", value.text);
+            }
+            else if (value.kind == ValueKind::Compare) {
+                const char* cc = compare(value);
+                emit("set" + std::string(cc), "al");
+                emit("movzx", "eax", "al");
+                emit("push", "eax");
+            }
+            else {
+                return;
+            }
+            value.kind = ValueKind::Stack;
+        }
+
+        // 机器栈上的值必须按求值顺序排列：一个值入栈之前，它下面的值都要先入栈
+        void spill() {
+            for (Value& value : stack_) {
+                push(value);
+            }
+        }
+
+        // select 的操作数：在栈上时弹到 reg，否则直接使用
+        std::string operand(const Value& value, const char* reg) {
+            if (value.kind == ValueKind::Stack) {
+                emit("pop", reg);
+                return reg;
+            }
+            return value.text;
+        }
+
+        // 生成设置标志位的 cmp，返回条件成立时的条件码
+        const char* compare(const Value& condition) {
+            if (condition.kind == ValueKind::Compare) {
+                if (!condition.onStack) {
+                    emit("push", condition.text);
+                    emit("push", condition.right);
+                }
+                emit("pop", "edx");
+                emit("pop", "eax");
+                emit("cmp", "eax", "edx");
+                return condition.cc;
+            }
+            if (condition.kind == ValueKind::Operand) {
+                emit("push", condition.text);
+            }
+            emit("pop", "eax");
+            emit("cmp", "eax", "0");
+            return "ne";
+        }
+
+        template <typename... Operands>
+        void emit(std::string op, Operands&&... operands) {
+            blocks_.back().body.emplace_back(std::move(op), std::string(std::forward<Operands>(operands))...);
+        }
+
+        // 跳转之后开始一个没有标号的新块
+        void endBlock(Instruction terminator) {
+            blocks_.back().terminator = std::move(terminator);
+            blocks_.emplace_back();
+        }
+
+        std::vector<Value> stack_;
+        std::vector<BasicBlock> blocks_;
+        std::vector<ArrayStorage> arrays_;
+
+        bool recording_ = false;
+        std::vector<std::string_view> recorded_;
+        std::size_t vectorLength_ = 0;
+        std::string vectorLabel_;
+    };
+}
+
+namespace {
+    const PeepholeOptimizer& defaultOptimizer() {
+        static const PeepholeOptimizer optimizer;
+        return optimizer;
+    }
+}
+
+void convertToAssembly(const std::string& expression, OutputBuffer& out, bool optimize, PeepholeStats* stats) {
+    Translator translator;
+    translator.translate(expression);
+    if (optimize) {
+        translator.optimize(defaultOptimizer(), stats);
+    }
+    translator.write(out);
+}
+
+std::string convertToAssembly(const std::string& expression) {
+    OutputBuffer out;
+    convertToAssembly(expression, out);
+    return std::string(out.view());
+}
+
+void writeStringData(const StringPool& strings, OutputBuffer& out) {
+    for (std::uint32_t id = 0; id < strings.size(); ++id) {
+        // 先是 8 字节的长度，再是内容，常量中间可以有 '\0'。
+        // 可显示的字符放在引号里，其余字节（包括引号本身）写成数值
+        std::string_view text = strings.text(id);
+        out << stringLabel(std::to_string(id)) << ": dq " << text.size() << '\n';
+        if (text.empty()) {
+            continue;
+        }
+        out << "db ";
+        bool quoted = false;
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            unsigned char byte = static_cast<unsigned char>(text[i]);
+            bool printable = byte >= 0x20 && byte != '"' && byte != 0x7f;
+            if (i > 0 && (!printable || !quoted)) {
+                out << (quoted ? "\", " : ", ");
+                quoted = false;
+            }
+            if (printable && !quoted) {
+                out << '"';
+                quoted = true;
+            }
+            if (printable) {
+                out << text[i];
+            }
+            else {
+                out << static_cast<int>(byte);
+            }
+        }
+        out << (quoted ? "\"\n" : "\n");
+    }
+}
+
+namespace {
+    bool isImmediate(std::string_view text) {
+        return !text.empty() && (std::isdigit(static_cast<unsigned char>(text[0])) || text[0] == '-');
+    }
+
+    // 数据段中的名字：变量 v_a 或字符串 str_N，其余都是寄存器或立即数
+    bool isSymbol(std::string_view text) {
+        return text.compare(0, 2, "v_") == 0 || text.compare(0, 4, "str_") == 0;
+    }
+
+    bool isStackArithmetic(const Instruction& instruction) {
+        return instruction.count == 0 &&
+            (instruction.is("add") || instruction.is("sub") || instruction.is("mul") || instruction.is("div"));
+    }
+
+    // .ascii 的内容：引号、反斜杠和不可显示的字节写成转义
+    void writeAscii(std::string_view text, OutputBuffer& out) {
+        out << '"';
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            }
+            else if (byte >= 0x20 && byte < 0x7f) {
+                out << c;
+            }
+            else {
+                char octal[5] = { '\\', static_cast<char>('0' + (byte >> 6)), static_cast<char>('0' + ((byte >> 3) & 7)),
+                    static_cast<char>('0' + (byte & 7)), 0 };
+                out << octal;
+            }
+        }
+        out << "\"\n";
+    }
+}
+
+void GasProgram::emit(const std::string& op, const std::string& a, const std::string& b) {
+    out_ << "    " << op;
+    if (!a.empty()) {
+        out_ << ' ' << a;
+    }
+    if (!b.empty()) {
+        out_ << ", " << b;
+    }
+    out_ << '\n';
+}
+
+void GasProgram::begin() {
+    if (started_) {
+        return;
+    }
+    started_ = true;
+    out_ << "    .intel_syntax noprefix\n"
+        << "    .text\n"
+        << "    .globl compiled_main\n"
+        << "    .type compiled_main, @function\n"
+        << "compiled_main:\n";
+    // rbx 在 call 前后保存 rsp，它是被调用者保存的寄存器
+    emit("push", "rbp");
+    emit("mov", "rbp", "rsp");
+    emit("push", "rbx");
+}
+
+// [名字 + 偏移] 用 rip 相对寻址；带寄存器下标的 [名字 + rcx*4] 只能用绝对地址
+std::string GasProgram::address(std::string_view inside) {
+    inside = inside.substr(1, inside.size() - 2);
+    std::string symbol;
+    std::string rest;
+    bool indexed = false;
+    std::size_t pos = 0;
+    while (pos <= inside.size()) {
+        std::size_t end = inside.find(" + ", pos);
+        if (end == std::string_view::npos) {
+            end = inside.size();
+        }
+        std::string_view part = inside.substr(pos, end - pos);
+        if (symbol.empty() && isSymbol(part)) {
+            symbol = std::string(part);
+        }
+        else {
+            indexed = indexed || !isImmediate(part);
+            rest += " + ";
+            rest += part;
+        }
+        pos = end + 3;
+    }
+    return indexed ? "[" + symbol + rest + "]" : "[rip + " + symbol + rest + "]";
+}
+
+std::string GasProgram::operand(const std::string& text, bool vector) {
+    if (text.empty() || isImmediate(text) || !registerFamily(text).empty()) {
+        return text;
+    }
+    if (text.compare(0, 6, "dword ") == 0) {
+        return "dword ptr " + address(std::string_view(text).substr(6));
+    }
+    if (text[0] == '[') {
+        return (vector ? "xmmword ptr " : "") + address(text);
+    }
+    if (text.compare(0, 2, "v_") == 0) {
+        // 标量变量
+        if (seen_.insert(text).second) {
+            scalars_.push_back(text);
+        }
+        return "dword ptr [rip + " + text + "]";
+    }
+    return text;
+}
+
+void GasProgram::lower(const Instruction& instruction) {
+    const std::string& op = instruction.op;
+    const std::string& first = instruction.operands[0];
+    if (isStackArithmetic(instruction)) {
+        // 窥孔优化没有改写掉的栈式运算
+        bool divide = op == "div";
+        emit("pop", divide ? "rcx" : "rdx");
+        emit("pop", "rax");
+        if (divide) {
+            emit("cdq");
+            emit("idiv", "ecx");
+        }
+        else {
+            emit(op == "mul" ? "imul" : op, "eax", "edx");
+        }
+        emit("push", "rax");
+        return;
+    }
+    if (op == "push" || op == "pop") {
+        // 64 位模式下 push/pop 只有 64 位形式；内存中的变量只有 4 字节，经过 r11 传递
+        std::string_view family = registerFamily(first);
+        if (!family.empty()) {
+            emit(op, std::string(family));
+        }
+        else if (op == "push" && isImmediate(first)) {
+            emit("push", first);
+        }
+        else if (op == "push") {
+            emit("mov", "r11d", operand(first, false));
+            emit("push", "r11");
+        }
+        else {
+            emit("pop", "r11");
+            emit("mov", operand(first, false), "r11d");
+        }
+        return;
+    }
+    if (op == "call") {
+        // 栈式代码可能在栈上留着值，调用 C 函数前把栈对齐到 16 字节
+        emit("mov", "rbx", "rsp");
+        emit("and", "rsp", "-16");
+        emit("call", first);
+        emit("mov", "rsp", "rbx");
+        return;
+    }
+    if (op[0] == 'j') {
+        emit(op, first);
+        return;
+    }
+    bool vector = op.compare(0, 5, "movdq") == 0;
+    out_ << "    " << op;
+    for (int i = 0; i < instruction.count; ++i) {
+        out_ << (i == 0 ? " " : ", ") << operand(instruction.operands[i], vector);
+    }
+    out_ << '\n';
+}
+
+void GasProgram::add(const std::string& expression, bool optimize, PeepholeStats* stats) {
+    Translator translator;
+    translator.translate(expression);
+    if (optimize) {
+        translator.optimize(defaultOptimizer(), stats);
+    }
+    begin();
+    const std::vector<BasicBlock>& blocks = translator.blocks();
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        const BasicBlock& block = blocks[i];
+        if (!block.label.empty()) {
+            out_ << block.label << ":\n";
+        }
+        for (const Instruction& instruction : block.body) {
+            lower(instruction);
+        }
+        if (!block.terminator.op.empty() && !translator.jumpsToNext(i)) {
+            lower(block.terminator);
+        }
+    }
+    for (const ArrayStorage& array : translator.arrays()) {
+        arrays_.push_back({ array.name, array.length });
+    }
+}
+
+void GasProgram::finish(const StringPool& strings) {
+    begin();
+    emit("mov", "rbx", "qword ptr [rbp - 8]");
+    emit("leave");
+    emit("ret");
+    out_ << "    .size compiled_main, .-compiled_main\n";
+    // 下标越界时从栈式代码中跳过来，栈不一定对齐，也不再返回
+    out_ << "bounds_error:\n";
+    emit("and", "rsp", "-16");
+    emit("call", "runtime_bounds_error");
+
+    // 变量表：先标量后数组；既声明成数组又当标量用过的名字只按数组存放
+    std::unordered_set<std::string> arrayNames;
+    for (const auto& array : arrays_) {
+        arrayNames.insert(array.first);
+    }
+    std::vector<std::pair<std::string, std::size_t>> variables;
+    for (const std::string& name : scalars_) {
+        if (!arrayNames.count(name)) {
+            variables.push_back({ name, 1 });
+        }
+    }
+    variables.insert(variables.end(), arrays_.begin(), arrays_.end());
+
+    out_ << "\n    .section .rodata\n";
+    for (std::uint32_t id = 0; id < strings.size(); ++id) {
+        // 与 print_string 的 struct string 对应：8 字节的长度，后面是内容，中间可以有 '\0'
+        std::string_view text = strings.text(id);
+        out_ << "    .balign 8\n" << stringLabel(std::to_string(id)) << ": .quad " << text.size() << "\n    .ascii ";
+        writeAscii(text, out_);
+    }
+    for (std::size_t i = 0; i < variables.size(); ++i) {
+        out_ << "name_" << i << ": .asciz \"" << variables[i].first.substr(2) << "\"\n";
+    }
+
+    out_ << "\n    .bss\n";
+    for (std::size_t i = 0; i < variables.size(); ++i) {
+        std::size_t length = variables[i].second;
+        bool array = i >= variables.size() - arrays_.size();
+        out_ << "    .balign " << (array ? 16 : 4) << '\n'
+            << variables[i].first << ": .zero " << (array ? paddedLength(length) : 1) * 4 << '\n';
+    }
+
+    out_ << "\n    .data\n    .balign 8\n    .globl compiled_variables\ncompiled_variables:\n";
+    for (std::size_t i = 0; i < variables.size(); ++i) {
+        out_ << "    .quad name_" << i << ", " << variables[i].first << ", " << variables[i].second << '\n';
+    }
+    out_ << "    .globl compiled_variable_count\ncompiled_variable_count:\n    .quad " << variables.size() << '\n';
+    out_ << "    .section .note.GNU-stack,\"\",@progbits\n";
+}
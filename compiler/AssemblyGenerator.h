@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "OutputBuffer.h"
+#include "Peephole.h"
+#include "StringPool.h"
+
+// 将逆波兰式翻译为汇编，结果追加到 out（可重复使用同一个缓冲区）
+// 条件跳转按基本块组织：jz 生成 cmp 与条件跳转，select 生成无分支的 cmov/setcc
+// optimize 为 true 时对每个基本块做窥孔优化，优化前后的指令数累加到 stats（可以为空）
+// 运算缺少操作数时抛出 std::runtime_error（GasProgram::add 相同）
+void convertToAssembly(const std::string& expression, OutputBuffer& out, bool optimize = true, PeepholeStats* stats = nullptr);
+
+std::string convertToAssembly(const std::string& expression);
+
+// 字符串常量的数据段：每个常量 str_下标: dq 长度，后面一行 db 字节（空串没有这一行），不以 0 结尾，可以含 NUL；
+// 与运行时库 print_string 的 struct string 布局相同，逆波兰式中的 $下标 引用这里的标号
+void writeStringData(const StringPool& strings, OutputBuffer& out);
+
+// 汇编的写法
+enum class AssemblySyntax {
+    Listing,  // 便于阅读的伪汇编清单（convertToAssembly 的输出），不能直接汇编
+    Gas       // GNU as 可以汇编、链接运行的 x86-64 程序（GasProgram）
+};
+
+// 把逐条语句的逆波兰式拼成一个完整的 GNU as 程序（.intel_syntax noprefix）：
+//   - 所有语句依次放在函数 compiled_main 中，栈式代码中的 push/pop 换成 64 位形式
+//   - 标量变量 x 放在 .bss 的 v_x（4 字节），数组放在 16 字节对齐的 v_数组名，字符串常量放在 .rodata
+//   - compiled_variables / compiled_variable_count 导出变量表（名字、地址、元素个数），运行时库据此检查结果
+//   - print_int、print_string、runtime_bounds_error 由运行时库（runtime/runtime.c）提供
+// 带下标的数组元素使用绝对地址，链接时需要 -no-pie
+class GasProgram {
+public:
+    explicit GasProgram(OutputBuffer& out) : out_(out) {}
+
+    // 追加一条语句；optimize 与 convertToAssembly 相同
+    void add(const std::string& expression, bool optimize = true, PeepholeStats* stats = nullptr);
+
+    // 写出函数结尾、数据段和变量表
+    void finish(const StringPool& strings);
+
+private:
+    void begin();
+    std::string operand(const std::string& text, bool vector);
+    std::string address(std::string_view inside);
+    void lower(const Instruction& instruction);
+    void emit(const std::string& op, const std::string& a = std::string(), const std::string& b = std::string());
+
+    OutputBuffer& out_;
+    bool started_ = false;
+    std::vector<std::string> scalars_;                          // 按第一次出现的顺序
+    std::unordered_set<std::string> seen_;
+    std::vector<std::pair<std::string, std::size_t>> arrays_;   // 名字与声明的元素个数
+};
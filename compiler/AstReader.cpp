@@ -0,0 +1,260 @@
+﻿#include "AstReader.h"
+#include <cctype>
+#include <charconv>
+#include <iostream>
+#include <vector>
+#include "Token.h"
+
+bool isOperator(char ch) {
+    return ch == '+' || ch == '-' || ch == '*' || ch == '/';
+}
+
+namespace {
+    // 退回到 mark 处，读到文件尾之后也可以继续读
+    void unread(std::stringstream& ss, std::streampos mark) {
+        ss.clear();
+        ss.seekg(mark);
+    }
+
+    // 下一个单词是 expected 时读掉它，否则不移动
+    bool accept(std::stringstream& ss, const char* expected) {
+        std::streampos mark = ss.tellg();
+        std::string token;
+        if (ss >> token && token == expected) {
+            return true;
+        }
+        unread(ss, mark);
+        return false;
+    }
+
+    // 字符串常量 "..."：ss 停在起始引号上，常量中可以有空格，\" 不结束常量
+    bool readLiteral(std::stringstream& ss, std::string& literal) {
+        ss.get();
+        char c;
+        while (ss.get(c)) {
+            if (c == '"') {
+                return true;
+            }
+            literal += c;
+            if (c == '\\' && ss.get(c)) {
+                literal += c;
+            }
+        }
+        return false;
+    }
+
+    // 下标：表达式 ]
+    NodeId parseIndex(std::stringstream& ss, Ast& ast) {
+        NodeId index = parseExpression(ss, ast);
+        if (index == kNoNode || !accept(ss, "]")) {
+            std::cerr << "Expected closing bracket" << std::endl;
+            return kNoNode;
+        }
+        return index;
+    }
+}
+
+NodeId parseTerm(std::stringstream& ss, Ast& ast) {
+    std::string token;
+    ss >> token;
+
+    if (isdigit(static_cast<unsigned char>(token[0]))) {
+        int value = 0;
+        std::from_chars_result parsed = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (parsed.ec != std::errc()) {
+            std::cerr << "Integer out of range: " << token << std::endl;
+            return kNoNode;
+        }
+        if (token.size() > 2 && token.compare(token.size() - 2, 2, "[]") == 0) {
+            // 数组声明 N[]
+            return ast.addArrayNew(value);
+        }
+        return ast.addInt(value);
+    }
+    else if (token[0] == '"') {
+        // 退回到引号处按字符读取
+        ss.clear();
+        ss.seekg(-static_cast<std::streamoff>(token.size()), std::ios::cur);
+        std::string literal;
+        if (!readLiteral(ss, literal)) {
+            std::cerr << "Unterminated string literal" << std::endl;
+            return kNoNode;
+        }
+        return ast.addString(ast.strings().intern(literal, true));
+    }
+    else if (token == "(") {
+        NodeId expr = parseExpression(ss, ast);
+        if (expr == kNoNode) {
+            std::cerr << "Invalid expression" << std::endl;
+            return kNoNode;
+        }
+
+        std::string closingParenthesis;
+        ss >> closingParenthesis;
+        if (closingParenthesis != ")") {
+            std::cerr << "Expected closing parenthesis" << std::endl;
+            return kNoNode;
+        }
+
+        return expr;
+    }
+    else if (isalpha(static_cast<unsigned char>(token[0]))) {
+        if (accept(ss, "[")) {
+            // 数组元素 a [ i ]
+            NodeId index = parseIndex(ss, ast);
+            return index == kNoNode ? kNoNode : ast.addIndex(token, index);
+        }
+        // 变量引用
+        return ast.addVariable(token);
+    }
+    else {
+        std::cerr << "Invalid token: " << token << std::endl;
+        return kNoNode;
+    }
+}
+
+namespace {
+    // 分支：单条语句，或者 { 语句 ; 语句 ; }
+    NodeId parseBranch(std::stringstream& ss, Ast& ast) {
+        if (!accept(ss, "{")) {
+            return parseFactor(ss, ast);
+        }
+        std::vector<NodeId> statements;
+        while (!accept(ss, "}")) {
+            NodeId statement = parseFactor(ss, ast);
+            if (statement == kNoNode) {
+                return kNoNode;
+            }
+            statements.push_back(statement);
+            accept(ss, ";");
+            if (!ss) {
+                std::cerr << "Expected closing brace" << std::endl;
+                return kNoNode;
+            }
+        }
+        return ast.addBlock(statements);
+    }
+
+    // If-else Condition: 条件 If branch: 分支 [Else branch: 分支]
+    NodeId parseIfElse(std::stringstream& ss, Ast& ast) {
+        if (!accept(ss, "Condition:")) {
+            std::cerr << "Expected condition" << std::endl;
+            return kNoNode;
+        }
+        NodeId condition = parseCondition(ss, ast);
+        if (condition == kNoNode || !accept(ss, "If") || !accept(ss, "branch:")) {
+            std::cerr << "Expected if branch" << std::endl;
+            return kNoNode;
+        }
+        NodeId ifBranch = parseBranch(ss, ast);
+        if (ifBranch == kNoNode) {
+            return kNoNode;
+        }
+        NodeId elseBranch = kNoNode;
+        if (accept(ss, "Else")) {
+            if (!accept(ss, "branch:") || (elseBranch = parseBranch(ss, ast)) == kNoNode) {
+                std::cerr << "Expected else branch" << std::endl;
+                return kNoNode;
+            }
+        }
+        // 语句之间的分号：分支是单条语句时已经被它读走，是块时还留在 } 之后
+        accept(ss, ";");
+        return ast.addIfElse(condition, ifBranch, elseBranch);
+    }
+}
+
+NodeId parseFactor(std::stringstream& ss, Ast& ast) {
+    std::streampos mark = ss.tellg();
+    std::string token;
+    ss >> token;
+
+    if (token == "If-else") {
+        return parseIfElse(ss, ast);
+    }
+    else if (token == "print") {
+        NodeId value = parseExpression(ss, ast);
+        if (value == kNoNode) {
+            std::cerr << "Invalid expression" << std::endl;
+            return kNoNode;
+        }
+        accept(ss, ";");
+        return ast.addPrint(value);
+    }
+    else if (isalpha(static_cast<unsigned char>(token[0]))) {
+        std::string nextToken;
+        ss >> nextToken;
+        if (nextToken == "[") {
+            // 给数组元素赋值 a [ i ] = v
+            NodeId index = parseIndex(ss, ast);
+            if (index != kNoNode && accept(ss, "=")) {
+                NodeId expr = parseExpression(ss, ast);
+                if (expr == kNoNode) {
+                    std::cerr << "Invalid expression" << std::endl;
+                    return kNoNode;
+                }
+                accept(ss, ";");
+                return ast.addStore(token, index, expr);
+            }
+        }
+        else if (nextToken == "=") {
+            NodeId expr = parseExpression(ss, ast);
+            if (expr == kNoNode) {
+                std::cerr << "Invalid expression" << std::endl;
+                return kNoNode;
+            }
+
+            accept(ss, ";");
+
+            return ast.addAssignment(token, expr);
+        }
+    }
+
+    // 不是赋值语句，整条作为表达式读取
+    unread(ss, mark);
+    return parseExpression(ss, ast);
+}
+
+NodeId parseCondition(std::stringstream& ss, Ast& ast) {
+    NodeId left = parseExpression(ss, ast);
+    if (left == kNoNode) {
+        return kNoNode;
+    }
+    std::streampos mark = ss.tellg();
+    std::string token;
+    if (ss >> token && isComparisonOperator(token)) {
+        NodeId right = parseExpression(ss, ast);
+        if (right == kNoNode) {
+            std::cerr << "Invalid expression" << std::endl;
+            return kNoNode;
+        }
+        return ast.addBinaryOp(operatorFromText(token), left, right);
+    }
+    unread(ss, mark);
+    return left;
+}
+
+NodeId parseExpression(std::stringstream& ss, Ast& ast) {
+    NodeId left = parseTerm(ss, ast);
+    if (left == kNoNode) {
+        return kNoNode;
+    }
+
+    std::string token;
+    std::streampos mark = ss.tellg();
+    while (ss >> token && isOperator(token[0])) {
+        char op = token[0];
+
+        NodeId right = parseTerm(ss, ast);
+        if (right == kNoNode) {
+            std::cerr << "Invalid expression" << std::endl;
+            return kNoNode;
+        }
+
+        left = ast.addBinaryOp(op, left, right);
+        mark = ss.tellg();
+    }
+    // 读到的不是运算符（例如右括号），退回给调用者
+    unread(ss, mark);
+
+    return left;
+}
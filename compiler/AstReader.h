@@ -0,0 +1,20 @@
+﻿#pragma once
+#include <sstream>
+#include "AST.h"
+
+// 读回 printAst 输出的语法树文本（单词之间以空格分隔），供逆波兰式阶段使用
+// 节点建立在 ast 中，出错时返回 kNoNode
+
+bool isOperator(char ch);
+
+// 表达式：项 { 运算符 项 }
+NodeId parseExpression(std::stringstream& ss, Ast& ast);
+
+// 项：整数、变量、字符串常量或带括号的表达式
+NodeId parseTerm(std::stringstream& ss, Ast& ast);
+
+// 语句：赋值语句、If-else、print 或表达式
+NodeId parseFactor(std::stringstream& ss, Ast& ast);
+
+// 条件：表达式 [ 比较运算符 表达式 ]
+NodeId parseCondition(std::stringstream& ss, Ast& ast);
@@ -0,0 +1,83 @@
+﻿#pragma once
+#include <vector>
+#include "AST.h"
+
+// 语法树遍历框架
+//
+// 访问者不需要继承任何类，只要提供用到的回调；回调按 AstNode::kind 自行区分节点种别，
+// 编译器可以把回调内联进遍历循环。
+
+// 完整的深度优先遍历，使用显式栈：
+//   bool enter(NodeId, const AstNode&)        进入节点，返回 false 时跳过其子树
+//   void between(NodeId, const AstNode&, int)  在第 i 个子节点（i >= 1）之前调用，用于中序输出
+//   void leave(NodeId, const AstNode&)         所有子节点处理完之后调用
+template <typename Visitor>
+void walk(const Ast& ast, NodeId root, Visitor& visitor) {
+    struct Frame {
+        NodeId id;
+        int next;  // 下一个要访问的子节点
+    };
+    if (root == kNoNode) {
+        return;
+    }
+    std::vector<Frame> stack;
+    stack.reserve(64);
+    if (!visitor.enter(root, ast.node(root))) {
+        return;
+    }
+    stack.push_back({ root, 0 });
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const AstNode& node = ast.node(frame.id);
+        int count = node.childCount();
+        // 跳过空的子节点（例如没有 else 分支）
+        while (frame.next < count && node.children[frame.next] == kNoNode) {
+            frame.next++;
+        }
+        if (frame.next >= count) {
+            visitor.leave(frame.id, node);
+            stack.pop_back();
+            continue;
+        }
+        int index = frame.next++;
+        if (index > 0) {
+            visitor.between(frame.id, node, index);
+        }
+        NodeId child = node.children[index];
+        if (visitor.enter(child, ast.node(child))) {
+            stack.push_back({ child, 0 });
+        }
+    }
+}
+
+namespace detail {
+    template <typename F>
+    struct PreOrder {
+        F& f;
+        bool enter(NodeId id, const AstNode& node) { f(id, node); return true; }
+        void between(NodeId, const AstNode&, int) {}
+        void leave(NodeId, const AstNode&) {}
+    };
+
+    template <typename F>
+    struct PostOrder {
+        F& f;
+        bool enter(NodeId, const AstNode&) { return true; }
+        void between(NodeId, const AstNode&, int) {}
+        void leave(NodeId id, const AstNode& node) { f(id, node); }
+    };
+}
+
+// 先序遍历：f(NodeId, const AstNode&)
+template <typename F>
+void walkPreOrder(const Ast& ast, NodeId root, F&& f) {
+    detail::PreOrder<F> visitor{ f };
+    walk(ast, root, visitor);
+}
+
+// 后序遍历：子节点总是先于父节点
+template <typename F>
+void walkPostOrder(const Ast& ast, NodeId root, F&& f) {
+    detail::PostOrder<F> visitor{ f };
+    walk(ast, root, visitor);
+}
@@ -0,0 +1,348 @@
+﻿#include "BuildDriver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include "ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    bool hasWildcard(const std::string& text) {
+        return text.find_first_of("*?") != std::string::npos;
+    }
+
+    // 简单通配符：* 匹配任意个字符，? 匹配一个字符
+    bool matchWildcard(const std::string& pattern, const std::string& name) {
+        std::size_t p = 0, n = 0;
+        std::size_t star = std::string::npos, resume = 0;
+        while (n < name.size()) {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+                p++;
+                n++;
+            }
+            else if (p < pattern.size() && pattern[p] == '*') {
+                star = p++;
+                resume = n;
+            }
+            else if (star != std::string::npos) {
+                p = star + 1;
+                n = ++resume;
+            }
+            else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*') {
+            p++;
+        }
+        return p == pattern.size();
+    }
+
+    // 构建写出的中间文件，展开目录时跳过，重复构建同一目录不会把它们当成源文件
+    bool isArtifact(const std::string& name) {
+        static const char* const suffixes[] = { ".tokens.txt", ".ast.txt", ".rpn.txt", ".asm", ".s" };
+        for (std::string_view suffix : suffixes) {
+            if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readFile(const std::string& path, std::string& content) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+    // 输出目录下的一级路径：%、:、/、\ 写成 %25、%3A、%2F、%5C，.. 写成 %2E%2E，根目录因此是 %2F。
+    // 不同的输入路径对应不同的输出路径，也不会跑到输出目录外面
+    std::string escapePart(const std::string& part) {
+        if (part == "..") {
+            return "%2E%2E";
+        }
+        std::string escaped;
+        for (char c : part) {
+            if (c == '%') {
+                escaped += "%25";
+            }
+            else if (c == ':') {
+                escaped += "%3A";
+            }
+            else if (c == '/') {
+                escaped += "%2F";
+            }
+            else if (c == '\\') {
+                escaped += "%5C";
+            }
+            else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    // 中间文件的路径前缀：保留完整的文件名，再加上中间文件的扩展名（x.txt → x.txt.asm），
+    // x.txt 和 x.src 不会写到同一个文件。有输出目录时按上面的规则保留输入的整个路径
+    fs::path artifactBase(const std::string& input, const BuildOptions& options) {
+        fs::path path = fs::path(input).lexically_normal();
+        if (options.outputDirectory.empty()) {
+            return path;
+        }
+        fs::path base(options.outputDirectory);
+        for (const fs::path& part : path) {
+            if (part != "." && !part.empty()) {
+                base /= escapePart(part.string());
+            }
+        }
+        return base;
+    }
+
+    bool writeArtifact(const fs::path& path, std::string_view content, FileReport& report) {
+        OutputBuffer file;
+        if (!file.open(path.string())) {
+            report.diagnostics.push_back("Failed to open file: " + path.string());
+            return false;
+        }
+        file << content;
+        if (!file.close()) {
+            report.diagnostics.push_back("Failed to write file: " + path.string());
+            return false;
+        }
+        return true;
+    }
+
+    // 与 latexanaly、Pareranaly、convertToReversePolish、Target 写出的文件格式相同
+    bool writeArtifacts(const CompileResult& result, AssemblySyntax syntax, const fs::path& base, FileReport& report) {
+        std::error_code error;
+        if (base.has_parent_path()) {
+            fs::create_directories(base.parent_path(), error);
+        }
+        if (error) {
+            report.diagnostics.push_back("Failed to create directory: " + base.parent_path().string());
+            return false;
+        }
+
+        OutputBuffer text;
+        for (std::size_t i = 0; i < result.tokens.size(); ++i) {
+            text << " TokenType::" << tokenCodeName(result.tokens.kind(i)) << " ,\"" << result.tokens.value(i) << "\" " << '\n';
+        }
+        bool ok = writeArtifact(base.string() + ".tokens.txt", text.view(), report);
+
+        text.clear();
+        for (NodeId root : result.ast.statements()) {
+            printAst(result.ast, root, text);
+            text << " ;\n";
+        }
+        ok = writeArtifact(base.string() + ".ast.txt", text.view(), report) && ok;
+
+        text.clear();
+        for (const std::string& instruction : result.rpn) {
+            text << instruction << " ";
+        }
+        if (!result.ast.strings().empty()) {
+            text << '\n';
+            writeStringTable(result.ast.strings(), text);
+        }
+        ok = writeArtifact(base.string() + ".rpn.txt", text.view(), report) && ok;
+
+        // GAS 语法的汇编写成 .s，可以直接交给 cc 汇编
+        const char* suffix = syntax == AssemblySyntax::Gas ? ".s" : ".asm";
+        return writeArtifact(base.string() + suffix, result.assembly.view(), report) && ok;
+    }
+
+    void buildFile(const std::string& path, const BuildOptions& options, FileReport& report) {
+        Clock::time_point start = Clock::now();
+        report.path = path;
+
+        std::string source;
+        if (!readFile(path, source)) {
+            report.diagnostics.push_back("Failed to open file: " + path);
+            report.seconds = secondsSince(start);
+            return;
+        }
+        report.bytes = source.size();
+        double io = secondsSince(start);
+
+        // 每个工作线程复用自己的编译上下文
+        const CompileResult& result = compile(source, options.compile);
+        report.ok = result.ok;
+        report.timings = result.timings;
+        report.diagnostics.insert(report.diagnostics.end(), result.diagnostics.begin(), result.diagnostics.end());
+
+        if (options.writeArtifacts) {
+            Clock::time_point writeStart = Clock::now();
+            if (!writeArtifacts(result, options.compile.syntax, artifactBase(path, options), report)) {
+                report.ok = false;
+            }
+            io += secondsSince(writeStart);
+        }
+        report.io = io;
+        report.seconds = secondsSince(start);
+    }
+
+    void appendSeconds(OutputBuffer& out, double seconds) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f s", seconds);
+        out << text;
+    }
+}
+
+std::vector<std::string> expandInputs(const std::vector<std::string>& inputs, std::vector<std::string>& diagnostics) {
+    std::vector<std::string> files;
+    for (const std::string& input : inputs) {
+        std::error_code error;
+        fs::path path(input);
+        if (hasWildcard(path.filename().string())) {
+            fs::path directory = path.has_parent_path() ? path.parent_path() : fs::path(".");
+            std::string pattern = path.filename().string();
+            std::vector<std::string> matches;
+            for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+                if (it->is_regular_file(error) && matchWildcard(pattern, it->path().filename().string())) {
+                    matches.push_back((path.has_parent_path() ? directory / it->path().filename() : it->path().filename()).string());
+                }
+            }
+            if (matches.empty()) {
+                diagnostics.push_back("No files match: " + input);
+            }
+            std::sort(matches.begin(), matches.end());
+            files.insert(files.end(), matches.begin(), matches.end());
+        }
+        else if (fs::is_directory(path, error)) {
+            std::vector<std::string> found;
+            for (fs::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+                if (it->is_regular_file(error) && !isArtifact(it->path().filename().string())) {
+                    found.push_back(it->path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        }
+        else if (fs::exists(path, error)) {
+            files.push_back(input);
+        }
+        else {
+            diagnostics.push_back("No such file or directory: " + input);
+        }
+    }
+    return files;
+}
+
+BuildReport buildFiles(const std::vector<std::string>& files, const BuildOptions& options) {
+    Clock::time_point start = Clock::now();
+    BuildReport report;
+    report.files.resize(files.size());
+    {
+        ThreadPool pool(options.jobs);
+        report.jobs = pool.size();
+        // 每个文件一个任务，结果写到各自的位置，不需要加锁。
+        // 任务中的异常记为这个文件的错误，不从 wait 抛出，也不影响其他文件
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            pool.submit([&files, &options, &report, i] {
+                FileReport& file = report.files[i];
+                try {
+                    buildFile(files[i], options, file);
+                }
+                catch (const std::exception& e) {
+                    file.path = files[i];
+                    file.ok = false;
+                    file.diagnostics.push_back(std::string("Internal error: ") + e.what());
+                }
+                catch (...) {
+                    file.path = files[i];
+                    file.ok = false;
+                    file.diagnostics.push_back("Internal error: unknown exception");
+                }
+            });
+        }
+        pool.wait();
+        report.steals = pool.steals();
+    }
+    for (const FileReport& file : report.files) {
+        if (!file.ok) {
+            report.failed++;
+        }
+    }
+    report.seconds = secondsSince(start);
+    return report;
+}
+
+void printDiagnostics(const BuildReport& report, OutputBuffer& out) {
+    for (const FileReport& file : report.files) {
+        for (const std::string& diagnostic : file.diagnostics) {
+            out << file.path << ": " << diagnostic << '\n';
+        }
+    }
+}
+
+void printTimingSummary(const BuildReport& report, OutputBuffer& out) {
+    CompileTimings total;
+    double io = 0;
+    std::size_t bytes = 0;
+    for (const FileReport& file : report.files) {
+        total.lex += file.timings.lex;
+        total.parse += file.timings.parse;
+        total.rpn += file.timings.rpn;
+        total.assembly += file.timings.assembly;
+        io += file.io;
+        bytes += file.bytes;
+    }
+
+    out << "Built " << report.files.size() << " files (" << report.failed << " failed) with "
+        << report.jobs << " jobs in ";
+    appendSeconds(out, report.seconds);
+    if (report.seconds > 0) {
+        char rate[64];
+        std::snprintf(rate, sizeof(rate), ", %.1f files/s, %.2f MB/s",
+            static_cast<double>(report.files.size()) / report.seconds, static_cast<double>(bytes) / report.seconds / 1e6);
+        out << rate;
+    }
+    out << '\n';
+
+    // 各阶段在所有线程上的累计耗时
+    const std::pair<const char*, double> stages[] = {
+        { "lex", total.lex },
+        { "parse", total.parse },
+        { "rpn", total.rpn },
+        { "asm", total.assembly },
+        { "io", io },
+    };
+    for (const auto& stage : stages) {
+        out << "  " << stage.first << std::string(8 - std::char_traits<char>::length(stage.first), ' ');
+        appendSeconds(out, stage.second);
+        out << '\n';
+    }
+    out << "  steals  " << report.steals << '\n';
+
+    std::vector<const FileReport*> slowest;
+    for (const FileReport& file : report.files) {
+        slowest.push_back(&file);
+    }
+    std::size_t count = std::min<std::size_t>(slowest.size(), 5);
+    std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(),
+        [](const FileReport* a, const FileReport* b) { return a->seconds > b->seconds; });
+    if (count > 0) {
+        out << "Slowest files:\n";
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        out << "  ";
+        appendSeconds(out, slowest[i]->seconds);
+        out << "  " << slowest[i]->path << '\n';
+    }
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Compiler.h"
+#include "OutputBuffer.h"
+
+// 多文件并行构建：每个输入文件在线程池上独立跑完 词法 → 语法 → 逆波兰式 → 汇编，
+// 各自写出中间文件，最后汇总诊断信息和耗时
+
+struct BuildOptions {
+    unsigned jobs = 0;                // 并行的线程数，0 表示硬件线程数
+    std::string outputDirectory;      // 中间文件的目录，空表示写在输入文件旁边
+    bool writeArtifacts = true;       // 是否写出 .tokens.txt、.ast.txt、.rpn.txt、.asm（GAS 语法时为 .s）
+    CompileOptions compile;
+};
+
+// 一个文件的构建结果
+struct FileReport {
+    std::string path;
+    bool ok = false;
+    std::size_t bytes = 0;
+    std::vector<std::string> diagnostics;
+    CompileTimings timings;
+    double io = 0;         // 读源文件和写中间文件的秒数
+    double seconds = 0;    // 这个文件的总耗时
+};
+
+struct BuildReport {
+    std::vector<FileReport> files;    // 与输入顺序一致
+    unsigned jobs = 0;
+    std::size_t failed = 0;
+    std::size_t steals = 0;
+    double seconds = 0;               // 整个构建的墙钟时间
+};
+
+// 展开命令行上的输入：普通文件原样保留，目录递归取出其中所有文件，
+// 文件名部分带 * 或 ? 的按通配符匹配同一目录下的文件。找不到的输入记到 diagnostics
+std::vector<std::string> expandInputs(const std::vector<std::string>& inputs, std::vector<std::string>& diagnostics);
+
+BuildReport buildFiles(const std::vector<std::string>& files, const BuildOptions& options = BuildOptions());
+
+// 按输入顺序输出带文件名的诊断信息
+void printDiagnostics(const BuildReport& report, OutputBuffer& out);
+
+// 输出文件数、各阶段累计耗时、吞吐量和最慢的几个文件
+void printTimingSummary(const BuildReport& report, OutputBuffer& out);
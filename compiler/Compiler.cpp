@@ -0,0 +1,132 @@
+﻿#include "Compiler.h"
+#include <cctype>
+#include <chrono>
+#include "AssemblyGenerator.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SemanticAnalyzer.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // 返回上次调用以来经过的秒数，并把 last 更新为当前时间
+    double lap(Clock::time_point& last) {
+        Clock::time_point now = Clock::now();
+        double seconds = std::chrono::duration<double>(now - last).count();
+        last = now;
+        return seconds;
+    }
+}
+
+std::string lexicalError(const TokenBuffer<TokenCode>& tokens, std::size_t index, const LineIndex& lines) {
+    SourceLocation at = lines.locate(tokens.offset(index));
+    std::string prefix = "Lexical error at " + std::to_string(at.line) + ":" + std::to_string(at.column);
+    if (tokens.value(index).front() == '"') {
+        return prefix + ": unterminated string literal";
+    }
+    if (std::isdigit(static_cast<unsigned char>(tokens.value(index).front()))) {
+        return prefix + ": integer " + std::string(tokens.value(index)) + " is out of range";
+    }
+    return prefix + ": unexpected character '" + std::string(tokens.value(index)) + "'";
+}
+
+const CompileResult& CompilerContext::compile(std::string_view source, const CompileOptions& options) {
+    // 源文本复制一份，单词直接引用它；assign 会复用已有容量
+    source_.assign(source.data(), source.size());
+
+    result_.ok = true;
+    result_.lines.reset(source_);
+    result_.ast.clear();
+    result_.rpn.clear();
+    result_.assembly.clear();
+    result_.diagnostics.clear();
+    result_.symbols.clear();
+    result_.removedStatements = 0;
+    result_.peephole.clear();
+    result_.timings = CompileTimings();
+    if (options.pipelined) {
+        compilePipelined(options);
+        return result_;
+    }
+    Clock::time_point last = Clock::now();
+
+    // 词法分析
+    Lexer lexer(source_);
+    lexer.setStringPool(&result_.ast.strings());
+    lexer.tokenize(result_.tokens);
+    for (std::size_t i = 0; i < result_.tokens.size(); ++i) {
+        if (result_.tokens.kind(i) == TokenCode::Error) {
+            result_.diagnostics.push_back(lexicalError(result_.tokens, i, result_.lines));
+            result_.ok = false;
+        }
+    }
+
+    result_.timings.lex = lap(last);
+
+    // 语法分析
+    Parser parser(result_.tokens, result_.ast);
+    parser.setDiagnostics(&result_.diagnostics);
+    parser.setLineIndex(&result_.lines);
+    parser.parseProgram();
+    if (!parser.atEnd()) {
+        result_.ok = false;
+    }
+
+    result_.timings.parse = lap(last);
+
+    // 中间代码与汇编
+    if (options.foldConstants) {
+        for (NodeId statement : result_.ast.statements()) {
+            SemanticAnalyzer::foldConstants(result_.ast, statement);
+        }
+    }
+    if (options.eliminateDeadAssignments) {
+        SemanticAnalyzer::checkAssignments(result_.ast, result_.symbols, &result_.diagnostics);
+        result_.removedStatements = SemanticAnalyzer::eliminateDeadAssignments(result_.ast, result_.symbols, options.keepFinalValues);
+    }
+    // 出错的语句生成的逆波兰式不完整，只翻译第一个语义错误之前的语句
+    std::size_t valid = 0;
+    if (options.generateRpn || options.generateAssembly) {
+        CodeGenContext context;
+        context.branchless = options.branchless;
+        context.diagnostics = &result_.diagnostics;
+        for (NodeId statement : result_.ast.statements()) {
+            SemanticAnalyzer::generateCode(result_.ast, statement, result_.rpn, context);
+            if (context.errors == 0) {
+                valid = result_.rpn.size();
+            }
+        }
+        if (context.errors != 0) {
+            result_.ok = false;
+        }
+    }
+    result_.timings.rpn = lap(last);
+    if (options.generateAssembly && options.syntax == AssemblySyntax::Gas) {
+        GasProgram program(result_.assembly);
+        for (std::size_t i = 0; i < valid; ++i) {
+            program.add(result_.rpn[i], options.peephole, &result_.peephole);
+        }
+        program.finish(result_.ast.strings());
+    }
+    else if (options.generateAssembly) {
+        for (std::size_t i = 0; i < valid; ++i) {
+            convertToAssembly(result_.rpn[i], result_.assembly, options.peephole, &result_.peephole);
+        }
+        writeStringData(result_.ast.strings(), result_.assembly);
+    }
+    result_.timings.assembly = lap(last);
+    if (!options.generateRpn) {
+        result_.rpn.clear();
+    }
+
+    return result_;
+}
+
+CompilerContext& threadCompilerContext() {
+    thread_local CompilerContext context;
+    return context;
+}
+
+const CompileResult& compile(std::string_view source, const CompileOptions& options) {
+    return threadCompilerContext().compile(source, options);
+}
@@ -0,0 +1,81 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AST.h"
+#include "AssemblyGenerator.h"
+#include "LineIndex.h"
+#include "OutputBuffer.h"
+#include "Peephole.h"
+#include "SymbolTable.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+
+// 在宿主进程内直接编译源代码，不经过四个命令行程序之间的中间文件
+
+struct CompileOptions {
+    bool generateRpn = true;       // 生成逆波兰式
+    bool generateAssembly = true;  // 生成汇编（需要逆波兰式）
+    bool foldConstants = false;    // 生成代码前做常量折叠
+    // 生成代码前做数据流分析：警告赋值之前就使用的变量，删除结果不会被读取的赋值。
+    // 分析需要整个编译单元，流水线模式下不做
+    bool eliminateDeadAssignments = true;
+    bool keepFinalValues = true;   // 程序结束时变量的值对外可见，最后一次赋值总是保留
+    bool branchless = true;        // 简单的条件赋值生成 cmov/setcc，而不是跳转
+    bool peephole = true;          // 对生成的汇编做窥孔优化
+    bool pipelined = false;        // 词法分析、语法分析、代码生成在三个线程上流水线执行，适合很大的单个文件
+    AssemblySyntax syntax = AssemblySyntax::Listing;  // Gas 时生成可以汇编运行的完整程序
+};
+
+// 各阶段耗时（秒）；流水线模式下各阶段重叠执行，记录的是每个阶段自己工作的时间，不含等待
+struct CompileTimings {
+    double lex = 0;
+    double parse = 0;
+    double rpn = 0;        // 常量折叠与逆波兰式
+    double assembly = 0;
+};
+
+// 一次编译的全部产物，引用所属 CompilerContext 中的缓冲区
+struct CompileResult {
+    bool ok = false;
+    TokenBuffer<TokenCode> tokens;                  // 单词的值引用 CompilerContext 保存的源文本副本
+    LineIndex lines;                                // 由 tokens.offset(i) 换算行列号，第一次用到时才建立
+    Ast ast;                                        // ast.statements() 中每条语句一棵语法树
+    std::vector<std::string> rpn;                   // 每条语句一行逆波兰式
+    OutputBuffer assembly;                          // 内存模式，用 assembly.view() 读取；只含第一个语义错误之前的语句
+    std::vector<std::string> diagnostics;           // 语法错误等诊断信息，以及赋值之前就使用变量的警告
+    SymbolTable symbols;                            // 名字引用 ast，不做数据流分析时为空
+    std::size_t removedStatements = 0;              // 删除的无用赋值等语句
+    PeepholeStats peephole;                         // 所有语句窥孔优化前后的指令数
+    CompileTimings timings;
+};
+
+// 编译上下文：在多次编译之间复用单词、输出等缓冲区，避免重复分配
+// 一个上下文同一时间只能被一个线程使用；不同上下文可以在不同线程中并发编译
+class CompilerContext {
+public:
+    CompilerContext() = default;
+    CompilerContext(const CompilerContext&) = delete;
+    CompilerContext& operator=(const CompilerContext&) = delete;
+
+    // 返回的结果在下一次调用 compile 之前有效
+    const CompileResult& compile(std::string_view source, const CompileOptions& options = CompileOptions());
+
+    const CompileResult& result() const { return result_; }
+
+private:
+    // CompilerPipeline.cpp：各阶段通过无锁环形队列传递单词批次和语句
+    void compilePipelined(const CompileOptions& options);
+
+    std::string source_;
+    CompileResult result_;
+};
+
+// 词法错误的诊断信息，带上行列号
+std::string lexicalError(const TokenBuffer<TokenCode>& tokens, std::size_t index, const LineIndex& lines);
+
+// 当前线程专用的编译上下文
+CompilerContext& threadCompilerContext();
+
+// 使用当前线程的上下文编译；结果在本线程下一次编译之前有效
+const CompileResult& compile(std::string_view source, const CompileOptions& options = CompileOptions());
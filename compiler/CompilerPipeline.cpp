@@ -0,0 +1,145 @@
+﻿#include "Compiler.h"
+#include <chrono>
+#include <thread>
+#include "AssemblyGenerator.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SemanticAnalyzer.h"
+#include "SpscRing.h"
+
+// 流水线模式
+//
+//   词法线程 --单词批次--> 语法线程 --语句批次--> 调用线程（常量折叠、逆波兰式、汇编）
+//
+// 词法分析器每次切出至少 kBatchTokens 个单词，并且停在两条顶层语句之间，语法线程因此可以
+// 独立解析每一批。每批语句建在自己的 Ast 里，交给下游之后就不再被改动，两边不需要加锁。
+// 词法错误和语法错误的行列号只在语法线程中换算，换行索引不会被两个线程同时建立。
+// 字符串常量只由词法线程登记到它自己的常量池，下游只传递下标，结束后整个常量池交给 result_.ast。
+// 各批次最后按顺序接到 result_.tokens 和 result_.ast 上，结果与顺序执行相同。
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t kBatchTokens = 4096;
+    constexpr std::size_t kRingSize = 8;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+void CompilerContext::compilePipelined(const CompileOptions& options) {
+    SpscRing<TokenBuffer<TokenCode>, kRingSize> tokenRing;
+    SpscRing<Ast, kRingSize> statementRing;
+    result_.tokens.reset(source_);
+    StringPool strings;
+
+    std::thread lexerThread([&] {
+        Lexer lexer(source_);
+        lexer.setStringPool(&strings);
+        TokenBuffer<TokenCode> batch;
+        while (true) {
+            Clock::time_point start = Clock::now();
+            bool more = lexer.tokenizeBatch(batch, kBatchTokens);
+            result_.timings.lex += secondsSince(start);
+            if (!more) {
+                break;
+            }
+            tokenRing.push(std::move(batch));
+        }
+        tokenRing.close();
+    });
+
+    // 词法错误和语法错误分开记录，合并时与顺序执行的顺序一致
+    std::vector<std::string> lexicalErrors;
+    std::vector<std::string> syntaxErrors;
+    bool stopped = false;
+    std::thread parserThread([&] {
+        TokenBuffer<TokenCode> batch;
+        while (tokenRing.pop(batch)) {
+            Clock::time_point start = Clock::now();
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                if (batch.kind(i) == TokenCode::Error) {
+                    lexicalErrors.push_back(lexicalError(batch, i, result_.lines));
+                }
+            }
+            // 出现语法错误后不再解析（与顺序执行一样），但仍然收集单词和词法错误
+            if (!stopped) {
+                Ast ast;
+                Parser parser(batch, ast);
+                parser.setDiagnostics(&syntaxErrors);
+                parser.setLineIndex(&result_.lines);
+                parser.parseProgram();
+                stopped = !parser.atEnd();
+                if (!ast.statements().empty()) {
+                    statementRing.push(std::move(ast));
+                }
+            }
+            result_.tokens.append(batch);
+            result_.timings.parse += secondsSince(start);
+        }
+        statementRing.close();
+    });
+
+    // 代码生成在调用线程上进行；数组声明在批次之间共享
+    std::vector<std::string> semanticErrors;
+    CodeGenContext context;
+    context.branchless = options.branchless;
+    context.diagnostics = &semanticErrors;
+    bool generate = options.generateRpn || options.generateAssembly;
+    bool gas = options.syntax == AssemblySyntax::Gas;
+    GasProgram program(result_.assembly);
+    Ast batch;
+    while (statementRing.pop(batch)) {
+        Clock::time_point start = Clock::now();
+        std::size_t first = result_.rpn.size();
+        std::size_t valid = first;
+        if (options.foldConstants) {
+            for (NodeId statement : batch.statements()) {
+                SemanticAnalyzer::foldConstants(batch, statement);
+            }
+        }
+        if (generate) {
+            // 与顺序执行相同，只翻译第一个语义错误之前的语句
+            for (NodeId statement : batch.statements()) {
+                SemanticAnalyzer::generateCode(batch, statement, result_.rpn, context);
+                if (context.errors == 0) {
+                    valid = result_.rpn.size();
+                }
+            }
+        }
+        result_.timings.rpn += secondsSince(start);
+
+        start = Clock::now();
+        if (options.generateAssembly) {
+            for (std::size_t i = first; i < valid; ++i) {
+                if (gas) {
+                    program.add(result_.rpn[i], options.peephole, &result_.peephole);
+                }
+                else {
+                    convertToAssembly(result_.rpn[i], result_.assembly, options.peephole, &result_.peephole);
+                }
+            }
+        }
+        result_.ast.append(batch);
+        result_.timings.assembly += secondsSince(start);
+    }
+
+    lexerThread.join();
+    parserThread.join();
+    result_.ast.strings() = std::move(strings);
+    if (options.generateAssembly && gas) {
+        program.finish(result_.ast.strings());
+    }
+    else if (options.generateAssembly) {
+        writeStringData(result_.ast.strings(), result_.assembly);
+    }
+
+    result_.diagnostics = lexicalErrors;
+    result_.diagnostics.insert(result_.diagnostics.end(), syntaxErrors.begin(), syntaxErrors.end());
+    result_.diagnostics.insert(result_.diagnostics.end(), semanticErrors.begin(), semanticErrors.end());
+    result_.ok = lexicalErrors.empty() && !stopped && context.errors == 0;
+    if (!options.generateRpn) {
+        result_.rpn.clear();
+    }
+}
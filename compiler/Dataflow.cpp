@@ -0,0 +1,347 @@
+﻿#include <algorithm>
+#include <iostream>
+#include "AstWalk.h"
+#include "SemanticAnalyzer.h"
+
+namespace {
+    struct UseChecker {
+        const Ast& ast;
+        SymbolTable& symbols;
+        std::vector<std::string>* diagnostics;
+        std::size_t statement = 0;
+        std::vector<char> reported{};
+        std::size_t warnings = 0;
+        // 生成代码时会报语义错误的语句要记为 pinned，死代码删除不能把错误藏起来。
+        // 下面的判断与 RpnEmitter 的检查一一对应；vectorLength 不为 0 时检查的是逐元素赋值的右侧
+        std::uint32_t vectorLength = 0;
+        bool rejected = false;
+
+        std::uint32_t symbol(NodeId node) {
+            std::uint32_t id = symbols.intern(ast.name(ast.node(node)));
+            symbols.bind(node, id);
+            if (reported.size() < symbols.size()) {
+                reported.resize(symbols.size(), 0);
+            }
+            return id;
+        }
+
+        void warn(std::string_view name) {
+            warnings++;
+            std::string message = "Semantic warning: '" + std::string(name) + "' is used before it is assigned in statement " +
+                std::to_string(statement + 1);
+            if (diagnostics) {
+                diagnostics->push_back(message);
+            }
+            else {
+                std::cerr << message << std::endl;
+            }
+        }
+
+        // 下标所指的数组已经声明，常量下标在范围内
+        bool validIndex(const AstNode& node, std::uint32_t length) const {
+            const AstNode& subscript = ast.node(node.children[0]);
+            return length != 0 &&
+                (subscript.kind != NodeKind::Int || (subscript.value >= 0 && subscript.value < static_cast<long long>(length)));
+        }
+
+        void read(NodeId at, const AstNode& node) {
+            switch (node.kind) {
+            case NodeKind::Int:
+                return;
+            case NodeKind::BinaryOp:
+                rejected = rejected || (vectorLength != 0 && isComparison(node.op));
+                return;
+            case NodeKind::Variable:
+            case NodeKind::Index:
+                break;
+            default:
+                // 字符串只能输出，N[] 只能是赋值的整个右侧，赋值只能作为语句
+                rejected = true;
+                return;
+            }
+            std::uint32_t id = symbol(at);
+            symbols.symbol(id).uses++;
+            std::uint32_t length = symbols.symbol(id).length;
+            if (node.kind == NodeKind::Index) {
+                rejected = rejected || vectorLength != 0 || !validIndex(node, length);
+                return;
+            }
+            // 标量表达式中不能有数组，逐元素赋值中的数组长度要相同
+            rejected = rejected || (length != 0 && (vectorLength == 0 || length != vectorLength));
+            if (!symbols.assigned(id) && !reported[id]) {
+                reported[id] = 1;
+                warn(ast.name(node));
+            }
+        }
+
+        void use(NodeId expression) {
+            // 大多数右侧只是一个整数或变量，不必启动遍历
+            const AstNode& node = ast.node(expression);
+            if (node.childCount() == 0) {
+                read(expression, node);
+                return;
+            }
+            walkPreOrder(ast, expression, [&](NodeId at, const AstNode& node) { read(at, node); });
+        }
+
+        void pinIfRejected(NodeId id) {
+            if (rejected) {
+                symbols.pin(id);
+            }
+            rejected = false;
+        }
+
+        void visit(NodeId id) {
+            const AstNode& node = ast.node(id);
+            switch (node.kind) {
+            case NodeKind::Assignment: {
+                const AstNode& value = ast.node(node.children[0]);
+                std::uint32_t target = symbol(id);
+                if (value.kind == NodeKind::ArrayNew) {
+                    // 重复声明和长度不是正数的声明在生成代码时报错，不记录长度
+                    if (symbols.symbol(target).length == 0 && value.value > 0) {
+                        symbols.symbol(target).length = static_cast<std::uint32_t>(value.value);
+                    }
+                }
+                else {
+                    vectorLength = symbols.symbol(target).length;
+                    use(node.children[0]);
+                    if (vectorLength != 0 && SemanticAnalyzer::analyze(ast, node.children[0]).maxDepth > kMaxVectorDepth) {
+                        rejected = true;
+                    }
+                    vectorLength = 0;
+                    pinIfRejected(id);
+                }
+                symbols.symbol(target).definitions++;
+                symbols.assign(target);
+                break;
+            }
+            case NodeKind::Store: {
+                use(node.children[0]);
+                use(node.children[1]);
+                std::uint32_t target = symbol(id);
+                rejected = rejected || !validIndex(node, symbols.symbol(target).length);
+                pinIfRejected(id);
+                symbols.symbol(target).definitions++;
+                break;
+            }
+            case NodeKind::Block:
+                for (NodeId block = id; block != kNoNode; block = ast.node(block).children[1]) {
+                    if (ast.node(block).children[0] != kNoNode) {
+                        visit(ast.node(block).children[0]);
+                    }
+                }
+                break;
+            case NodeKind::IfElse: {
+                use(node.children[0]);
+                pinIfRejected(id);
+                symbols.enterScope();
+                visit(node.children[1]);
+                std::vector<std::uint32_t> thenAssigned = symbols.leaveScope();
+                std::vector<std::uint32_t> elseAssigned;
+                if (node.children[2] != kNoNode) {
+                    symbols.enterScope();
+                    visit(node.children[2]);
+                    elseAssigned = symbols.leaveScope();
+                }
+                // 两个分支都赋过值的变量在 if 语句之后才算赋过值
+                std::sort(thenAssigned.begin(), thenAssigned.end());
+                std::sort(elseAssigned.begin(), elseAssigned.end());
+                std::vector<std::uint32_t> both;
+                std::set_intersection(thenAssigned.begin(), thenAssigned.end(), elseAssigned.begin(), elseAssigned.end(),
+                    std::back_inserter(both));
+                for (std::uint32_t assigned : both) {
+                    symbols.assign(assigned);
+                }
+                break;
+            }
+            case NodeKind::Print:
+                // 输出语句不会被删除，不必检查
+                if (ast.node(node.children[0]).kind != NodeKind::String) {
+                    use(node.children[0]);
+                }
+                rejected = false;
+                break;
+            default:
+                use(id);
+                rejected = false;
+                break;
+            }
+        }
+    };
+
+    // 表达式在运行时可能出错：除数不是非零常量，或者下标不是常量（常量下标在生成代码时检查）
+    bool mayTrap(const Ast& ast, NodeId expression) {
+        if (ast.node(expression).childCount() == 0) {
+            return false;
+        }
+        bool trap = false;
+        walkPreOrder(ast, expression, [&](NodeId, const AstNode& node) {
+            if (node.kind == NodeKind::BinaryOp && node.op == '/') {
+                const AstNode& divisor = ast.node(node.children[1]);
+                trap = trap || divisor.kind != NodeKind::Int || divisor.value == 0 || divisor.value == -1;
+            }
+            else if (node.kind == NodeKind::Index) {
+                trap = trap || ast.node(node.children[0]).kind != NodeKind::Int;
+            }
+        });
+        return trap;
+    }
+
+    bool isEmptyBlock(const AstNode& node) {
+        return node.kind == NodeKind::Block && node.children[0] == kNoNode && node.children[1] == kNoNode;
+    }
+
+    // 语言中没有循环，从后往前扫描一遍语句就得到每一点的活跃变量
+    struct Liveness {
+        Ast& ast;
+        const SymbolTable& symbols;
+        std::vector<char> live;
+        std::size_t removed = 0;
+
+        void use(NodeId expression) {
+            const AstNode& node = ast.node(expression);
+            if (node.childCount() == 0) {
+                if (node.kind == NodeKind::Variable) {
+                    live[symbols.reference(expression)] = 1;
+                }
+                return;
+            }
+            walkPreOrder(ast, expression, [&](NodeId id, const AstNode& node) {
+                if (node.kind == NodeKind::Variable || node.kind == NodeKind::Index) {
+                    live[symbols.reference(id)] = 1;
+                }
+            });
+        }
+
+        // 返回 true 表示语句可以删除，此时不更新活跃变量
+        bool visit(NodeId id) {
+            const AstNode& node = ast.node(id);
+            switch (node.kind) {
+            case NodeKind::Assignment: {
+                std::uint32_t target = symbols.reference(id);
+                NodeId value = node.children[0];
+                if (ast.node(value).kind == NodeKind::ArrayNew) {
+                    // 数组声明决定了生成代码时数组的长度，不能删除
+                    live[target] = 0;
+                    return false;
+                }
+                if (!live[target] && !mayTrap(ast, value) && !symbols.pinned(id)) {
+                    return true;
+                }
+                live[target] = 0;
+                use(value);
+                return false;
+            }
+            case NodeKind::Store: {
+                // 只改写一个元素，其余元素的旧值仍然可能被读取，不结束数组的活跃区间
+                const AstNode& index = ast.node(node.children[0]);
+                if (!live[symbols.reference(id)] && index.kind == NodeKind::Int && !mayTrap(ast, node.children[1]) &&
+                    !symbols.pinned(id)) {
+                    return true;
+                }
+                use(node.children[0]);
+                use(node.children[1]);
+                return false;
+            }
+            case NodeKind::Block:
+                block(id);
+                return false;
+            case NodeKind::IfElse: {
+                NodeId condition = node.children[0];
+                NodeId thenBranch = node.children[1];
+                NodeId elseBranch = node.children[2];
+                std::vector<char> after = live;
+                branch(thenBranch);
+                if (elseBranch != kNoNode) {
+                    live.swap(after);
+                    branch(elseBranch);
+                }
+                for (std::size_t i = 0; i < live.size(); ++i) {
+                    live[i] |= after[i];
+                }
+                // 两个分支都已经空了，条件又不会出错，整个语句都可以删除
+                if (isEmptyBlock(ast.node(thenBranch)) && (elseBranch == kNoNode || isEmptyBlock(ast.node(elseBranch))) &&
+                    !mayTrap(ast, condition) && !symbols.pinned(id)) {
+                    return true;
+                }
+                use(condition);
+                return false;
+            }
+            default:
+                use(id);
+                return false;
+            }
+        }
+
+        // 单独作为分支的语句删除时改成空块
+        void branch(NodeId id) {
+            if (visit(id)) {
+                AstNode empty{ NodeKind::Block };
+                empty.op = '{';
+                ast.node(id) = empty;
+                removed++;
+            }
+        }
+
+        // 从后往前处理块中的语句，再把留下的语句按原来的顺序重新串到原有的 Block 节点上
+        void block(NodeId first) {
+            std::vector<NodeId> chain;
+            for (NodeId id = first; id != kNoNode; id = ast.node(id).children[1]) {
+                chain.push_back(id);
+            }
+            std::vector<NodeId> kept;
+            for (std::size_t i = chain.size(); i-- > 0;) {
+                NodeId statement = ast.node(chain[i]).children[0];
+                if (statement == kNoNode) {
+                    continue;
+                }
+                if (visit(statement)) {
+                    removed++;
+                }
+                else {
+                    kept.push_back(statement);
+                }
+            }
+            if (kept.size() + (ast.node(first).children[0] == kNoNode ? 1 : 0) == chain.size()) {
+                return;
+            }
+            std::reverse(kept.begin(), kept.end());
+            for (std::size_t i = 0; i < kept.size(); ++i) {
+                AstNode& link = ast.node(chain[i]);
+                link.children[0] = kept[i];
+                link.children[1] = i + 1 < kept.size() ? chain[i + 1] : kNoNode;
+            }
+            if (kept.empty()) {
+                ast.node(first).children[0] = ast.node(first).children[1] = kNoNode;
+            }
+        }
+    };
+}
+
+std::size_t SemanticAnalyzer::checkAssignments(const Ast& ast, SymbolTable& symbols, std::vector<std::string>* diagnostics) {
+    symbols.reserve(ast.nodeCount());
+    UseChecker checker{ ast, symbols, diagnostics };
+    for (; checker.statement < ast.statements().size(); ++checker.statement) {
+        checker.visit(ast.statements()[checker.statement]);
+    }
+    return checker.warnings;
+}
+
+std::size_t SemanticAnalyzer::eliminateDeadAssignments(Ast& ast, const SymbolTable& symbols, bool keepFinalValues) {
+    Liveness liveness{ ast, symbols, std::vector<char>(symbols.size(), keepFinalValues ? 1 : 0) };
+    std::vector<NodeId>& statements = ast.statements();
+    std::vector<NodeId> kept;
+    kept.reserve(statements.size());
+    for (std::size_t i = statements.size(); i-- > 0;) {
+        if (liveness.visit(statements[i])) {
+            liveness.removed++;
+        }
+        else {
+            kept.push_back(statements[i]);
+        }
+    }
+    std::reverse(kept.begin(), kept.end());
+    statements.swap(kept);
+    return liveness.removed;
+}
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "OutputBuffer.h"
+
+// 汇编指令：助记符加最多三个操作数，输出时才拼成文本，便于在生成之后继续做窥孔优化
+struct Instruction {
+    std::string op;
+    std::string operands[3];
+    int count = 0;
+
+    Instruction() = default;
+
+    explicit Instruction(std::string op) : op(std::move(op)) {}
+
+    Instruction(std::string op, std::string a) : op(std::move(op)), count(1) {
+        operands[0] = std::move(a);
+    }
+
+    Instruction(std::string op, std::string a, std::string b) : op(std::move(op)), count(2) {
+        operands[0] = std::move(a);
+        operands[1] = std::move(b);
+    }
+
+    Instruction(std::string op, std::string a, std::string b, std::string c) : op(std::move(op)), count(3) {
+        operands[0] = std::move(a);
+        operands[1] = std::move(b);
+        operands[2] = std::move(c);
+    }
+
+    bool is(std::string_view mnemonic) const { return op == mnemonic; }
+
+    // 输出一行：op a, b, c
+    void write(OutputBuffer& out) const {
+        out << op;
+        for (int i = 0; i < count; ++i) {
+            out << (i == 0 ? " " : ", ") << operands[i];
+        }
+        out << '\n';
+    }
+};
+
+using InstructionList = std::vector<Instruction>;
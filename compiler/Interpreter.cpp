@@ -0,0 +1,177 @@
+﻿#include "Interpreter.h"
+#include <limits>
+#include "AstWalk.h"
+
+bool Interpreter::fail(const std::string& message) {
+    if (error_.empty()) {
+        error_ = message;
+    }
+    return false;
+}
+
+bool Interpreter::run() {
+    for (NodeId statement : ast_.statements()) {
+        execute(statement);
+        if (!error_.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Interpreter::execute(NodeId id) {
+    // 块中的语句沿 Block 链依次执行，不递归
+    while (id != kNoNode && error_.empty()) {
+        const AstNode& node = ast_.node(id);
+        switch (node.kind) {
+        case NodeKind::Block:
+            if (node.children[0] != kNoNode) {
+                execute(node.children[0]);
+            }
+            id = node.children[1];
+            continue;
+        case NodeKind::IfElse:
+            id = evaluate(node.children[0]) != 0 ? node.children[1] : node.children[2];
+            continue;
+        case NodeKind::Assignment: {
+            std::string name(ast_.name(node));
+            const AstNode& value = ast_.node(node.children[0]);
+            if (value.kind == NodeKind::ArrayNew) {
+                variables_[name].assign(static_cast<std::size_t>(value.value), 0);
+                arrays_.insert(name);
+            }
+            else if (arrays_.count(name)) {
+                // 逐元素计算；同一个下标只读写同一个位置，可以直接写回
+                std::vector<std::int32_t>& target = variables_[name];
+                for (std::size_t i = 0; i < target.size() && error_.empty(); ++i) {
+                    std::int32_t result = evaluate(node.children[0], static_cast<std::int64_t>(i));
+                    variables_[name][i] = result;
+                }
+            }
+            else {
+                std::int32_t result = evaluate(node.children[0]);
+                variables_[name].assign(1, result);
+            }
+            break;
+        }
+        case NodeKind::Store: {
+            std::int32_t index = evaluate(node.children[0]);
+            std::int32_t result = evaluate(node.children[1]);
+            std::vector<std::int32_t>& target = variables_[std::string(ast_.name(node))];
+            if (index < 0 || static_cast<std::size_t>(index) >= target.size()) {
+                fail("index " + std::to_string(index) + " out of bounds for '" + std::string(ast_.name(node)) + "'");
+                break;
+            }
+            target[static_cast<std::size_t>(index)] = result;
+            break;
+        }
+        case NodeKind::Print: {
+            const AstNode& value = ast_.node(node.children[0]);
+            if (value.kind == NodeKind::String) {
+                output_ += ast_.strings().text(static_cast<std::uint32_t>(value.value));
+            }
+            else {
+                std::int32_t result = evaluate(node.children[0]);
+                if (error_.empty()) {
+                    output_ += std::to_string(result);
+                    output_ += '\n';
+                }
+            }
+            break;
+        }
+        default:
+            // 表达式语句：求值后丢弃
+            evaluate(id);
+            break;
+        }
+        break;
+    }
+}
+
+std::int32_t Interpreter::evaluate(NodeId id, std::int64_t element) {
+    values_.clear();
+    // 后序遍历就是逆波兰式的顺序，用一个栈求值
+    walkPostOrder(ast_, id, [&](NodeId, const AstNode& node) {
+        switch (node.kind) {
+        case NodeKind::Int:
+            values_.push_back(node.value);
+            break;
+        case NodeKind::Variable: {
+            auto it = variables_.find(std::string(ast_.name(node)));
+            std::int32_t value = 0;
+            if (it != variables_.end()) {
+                std::size_t index = element >= 0 && arrays_.count(it->first) ? static_cast<std::size_t>(element) : 0;
+                value = index < it->second.size() ? it->second[index] : 0;
+            }
+            values_.push_back(value);
+            break;
+        }
+        case NodeKind::Index: {
+            std::int32_t index = values_.back();
+            values_.pop_back();
+            auto it = variables_.find(std::string(ast_.name(node)));
+            if (it == variables_.end() || index < 0 || static_cast<std::size_t>(index) >= it->second.size()) {
+                fail("index " + std::to_string(index) + " out of bounds for '" + std::string(ast_.name(node)) + "'");
+                values_.push_back(0);
+                break;
+            }
+            values_.push_back(it->second[static_cast<std::size_t>(index)]);
+            break;
+        }
+        case NodeKind::BinaryOp: {
+            std::uint32_t right = static_cast<std::uint32_t>(values_.back());
+            values_.pop_back();
+            std::uint32_t left = static_cast<std::uint32_t>(values_.back());
+            values_.pop_back();
+            std::int32_t l = static_cast<std::int32_t>(left);
+            std::int32_t r = static_cast<std::int32_t>(right);
+            std::int32_t result = 0;
+            switch (node.op) {
+            case '+':
+                result = static_cast<std::int32_t>(left + right);
+                break;
+            case '-':
+                result = static_cast<std::int32_t>(left - right);
+                break;
+            case '*':
+                result = static_cast<std::int32_t>(left * right);
+                break;
+            case '/':
+                if (r == 0 || (l == std::numeric_limits<std::int32_t>::min() && r == -1)) {
+                    fail(r == 0 ? "division by zero" : "division overflow");
+                    break;
+                }
+                result = l / r;
+                break;
+            case kOpLess:
+                result = l < r;
+                break;
+            case kOpGreater:
+                result = l > r;
+                break;
+            case kOpLessEqual:
+                result = l <= r;
+                break;
+            case kOpGreaterEqual:
+                result = l >= r;
+                break;
+            case kOpEqual:
+                result = l == r;
+                break;
+            case kOpNotEqual:
+                result = l != r;
+                break;
+            default:
+                break;
+            }
+            values_.push_back(result);
+            break;
+        }
+        default:
+            // 语义检查已经排除了其他节点出现在表达式中的情况
+            values_.push_back(0);
+            break;
+        }
+    });
+    return values_.empty() ? 0 : values_.back();
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "AST.h"
+
+// 直接在语法树上执行程序，作为生成代码的参照（Harness 用它检查运行结果）
+//
+// 语义与生成的代码一致：32 位补码回绕，除法向零截断，变量初值为 0，条件非 0 为真，
+// 整个数组的赋值逐元素计算。只执行通过了语义检查的程序
+class Interpreter {
+public:
+    explicit Interpreter(const Ast& ast) : ast_(ast) {}
+
+    // 依次执行所有语句；除数为 0、除法溢出或下标越界时停止并返回 false
+    bool run();
+
+    // print 的输出，与运行时库 print_int / print_string 的输出相同
+    const std::string& output() const { return output_; }
+
+    // 出错的原因
+    const std::string& error() const { return error_; }
+
+    // 所有赋过值的变量，标量只有一个元素
+    const std::map<std::string, std::vector<std::int32_t>>& variables() const { return variables_; }
+
+private:
+    void execute(NodeId id);
+    // element 不小于 0 时，数组变量取第 element 个元素（整个数组的赋值）
+    std::int32_t evaluate(NodeId id, std::int64_t element = -1);
+    bool fail(const std::string& message);
+
+    const Ast& ast_;
+    std::map<std::string, std::vector<std::int32_t>> variables_;
+    std::unordered_set<std::string> arrays_;
+    std::vector<std::int32_t> values_;   // evaluate 的求值栈
+    std::string output_;
+    std::string error_;
+};
@@ -0,0 +1,190 @@
+﻿#include "Lexer.h"
+#include <charconv>
+#include <iostream>
+
+void Lexer::tokenize(TokenBuffer<TokenCode>& tokens) {
+    tokens.reset(input_);
+    tokens.reserve(input_.size() / 4);
+
+    while (pos_ < input_.size()) {
+        skipWhitespace();
+
+        if (pos_ >= input_.size()) {
+            // 输入结束
+            break;
+        }
+
+        lexToken(tokens);
+    }
+}
+
+bool Lexer::tokenizeBatch(TokenBuffer<TokenCode>& tokens, std::size_t minTokens) {
+    tokens.reset(input_);
+    tokens.reserve(minTokens + minTokens / 4);
+
+    while (pos_ < input_.size()) {
+        skipWhitespace();
+        if (pos_ >= input_.size()) {
+            break;
+        }
+
+        std::size_t first = tokens.size();
+        lexToken(tokens);
+
+        // 跟踪括号深度，顶层的 ; 或 } 之后是语句之间
+        bool boundary = false;
+        for (std::size_t i = first; i < tokens.size(); ++i) {
+            boundary = false;
+            if (!tokens.is(i, TokenCode::Delimiter)) {
+                continue;
+            }
+            char c = tokens.value(i)[0];
+            if (c == '(' || c == '{') {
+                depth_++;
+            }
+            else if (c == ')' || c == '}') {
+                depth_--;
+            }
+            boundary = depth_ <= 0 && (c == ';' || c == '}');
+        }
+
+        if (boundary && tokens.size() >= minTokens) {
+            // if 分支后面跟着 else 时还是同一条语句
+            skipWhitespace();
+            bool elseFollows = input_.compare(pos_, 4, "else") == 0 &&
+                !(isLetter(peek(4)) || isDigit(peek(4)));
+            if (!elseFollows) {
+                return true;
+            }
+        }
+    }
+    return !tokens.empty();
+}
+
+void Lexer::lexToken(TokenBuffer<TokenCode>& tokens) {
+    char currentChar = input_[pos_];
+    size_t start = pos_;
+    TokenCode code;
+
+    if (isLetter(currentChar)) {
+        // 标识符或关键字
+        std::string_view identifier = readIdentifier();
+
+        if (identifier == "if" || identifier == "else") {
+            // 关键字
+            tokens.push(TokenCode::Keyword, start, identifier.size());
+        }
+        else if (identifier == "print") {
+            tokens.push(TokenCode::Print, start, identifier.size());
+        }
+        else {
+            // 普通的标识符
+            tokens.push(TokenCode::Identifier, start, identifier.size());
+        }
+    }
+
+
+
+    else if (isDigit(currentChar)) {
+        // 整数或数组
+        std::string_view number = readNumber();
+        int value = 0;
+        if (std::from_chars(number.data(), number.data() + number.size(), value).ec != std::errc()) {
+            // 超出 int 范围，后面的 [] 照常作为分隔符
+            tokens.push(TokenCode::Error, start, number.size());
+        }
+        else if (peek(0) == '[' && peek(1) == ']') {
+            // 数组
+            pos_ += 2; // 跳过 '[' 和 ']'
+            registerArrayIdentifier(std::string(number), value);
+            tokens.push(TokenCode::Integer, start, number.size());
+            tokens.push(TokenCode::Delimiter, pos_ - 2, 1);
+            tokens.push(TokenCode::Delimiter, pos_ - 1, 1);
+        }
+        else {
+            // 整数
+            tokens.push(TokenCode::Integer, start, number.size());
+        }
+    }
+    
+  
+    else if (currentChar == '"') {
+        // 字符串常量，单词的值是带引号的原文
+        std::string_view literal;
+        if (!readStringLiteral(literal)) {
+            tokens.push(TokenCode::Error, start, pos_ - start);
+        }
+        else if (strings_) {
+            tokens.pushLiteral(TokenCode::StringLiteral, start, pos_ - start, strings_->intern(literal));
+        }
+        else {
+            tokens.push(TokenCode::StringLiteral, start, pos_ - start);
+        }
+    }
+    else if (peek(1) == '=' && lookupOperator(std::string{ currentChar, '=' }, code)) {
+        // 双字符比较运算符 == != <= >=
+        tokens.push(code, pos_, 2);
+        pos_ += 2;
+    }
+    else if (lookupOperator(std::string(1, currentChar), code)) {
+        // 操作符
+        tokens.push(code, pos_, 1);
+        pos_++;
+    }
+    else if (currentChar == '(' || currentChar == ')' || currentChar == ';' || currentChar == '{' || currentChar == '}' ||
+        currentChar == '[' || currentChar == ']') {
+        tokens.push(TokenCode::Delimiter, pos_, 1);
+        pos_++;
+    }
+    else {
+        // 错误字符
+        tokens.push(TokenCode::Error, pos_, 1);
+        pos_++;
+    }
+}
+
+std::vector<Token> Lexer::tokenize() {
+    TokenBuffer<TokenCode> buffer;
+    tokenize(buffer);
+
+    std::vector<Token> tokens;
+    tokens.reserve(buffer.size());
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        std::size_t offset = buffer.offset(i);
+        tokens.push_back({ buffer.kind(i), static_cast<std::uint32_t>(offset == buffer.kNoOffset ? 0 : offset), std::string(buffer.value(i)) });
+    }
+    return tokens;
+}
+
+void Lexer::printSymbolTable() const {
+    std::cout << "Symbol Table:" << std::endl;
+    for (const auto& entry : symbolTable_) {
+        std::cout << entry.first << std::endl;
+    }
+}
+
+bool Lexer::readStringLiteral(std::string_view& literal) {
+    // 跳过起始引号
+    size_t start = ++pos_;
+
+    while (pos_ < input_.size()) {
+        char currentChar = input_[pos_];
+        if (currentChar == '\\' && pos_ + 1 < input_.size() && input_[pos_ + 1] != '\n') {
+            // 转义字符连同反斜杠一起留在原文中
+            pos_ += 2;
+        }
+        else if (currentChar == '\"') {
+            // 遇到结束引号，停止读取
+            literal = input_.substr(start, pos_ - start);
+            ++pos_;
+            return true;
+        }
+        else if (currentChar == '\n') {
+            break;
+        }
+        else {
+            ++pos_;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,91 @@
+﻿#pragma once
+#include <cctype>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "StringPool.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+
+// 词法分析器
+class Lexer {
+public:
+    // 源文本不会被复制，必须比 Lexer 以及生成的 TokenBuffer 活得更久
+    Lexer(std::string_view input) : input_(input), pos_(0) {}
+
+    // 将单词追加到 tokens 中；单词的值直接引用源文本
+    void tokenize(TokenBuffer<TokenCode>& tokens);
+
+    // 流水线模式：清空 tokens 后从上次停下的位置继续，至少取 minTokens 个单词，
+    // 并且停在两条顶层语句之间（; 或 } 之后、后面不是 else）。没有单词可取时返回 false
+    bool tokenizeBatch(TokenBuffer<TokenCode>& tokens, std::size_t minTokens);
+
+    std::vector<Token> tokenize();
+
+    // 设置后字符串常量登记到 strings，单词记下常量的下标（TokenBuffer::literal）
+    void setStringPool(StringPool* strings) { strings_ = strings; }
+
+    void printSymbolTable() const;
+
+private:
+    std::string_view input_;
+    size_t pos_;
+    int depth_ = 0;  // tokenizeBatch 跟踪的括号深度
+    StringPool* strings_ = nullptr;
+    std::unordered_map<std::string, int> symbolTable_;
+
+    // 只前进位置，行列号在报告位置时由 LineIndex 换算
+    void skipWhitespace() {
+        while (pos_ < input_.size() && isWhitespace(input_[pos_])) {
+            pos_++;
+        }
+    }
+
+    // 越界时返回 '\0'
+    char peek(size_t ahead) const {
+        return pos_ + ahead < input_.size() ? input_[pos_ + ahead] : '\0';
+    }
+
+    bool isLetter(char c) {
+        return std::isalpha(static_cast<unsigned char>(c));
+    }
+
+    bool isDigit(char c) {
+        return std::isdigit(static_cast<unsigned char>(c));
+    }
+   
+
+    // CRLF 换行中的 '\r' 也是空白
+    bool isWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    std::string_view readIdentifier() {
+        size_t start = pos_;
+        while (pos_ < input_.size() && (isLetter(input_[pos_]) || isDigit(input_[pos_]))) {
+            pos_++;
+        }
+        return input_.substr(start, pos_ - start);
+    }
+
+    std::string_view readNumber() {
+        size_t start = pos_;
+        while (pos_ < input_.size() && isDigit(input_[pos_])) {
+            pos_++;
+        }
+        return input_.substr(start, pos_ - start);
+    }
+
+    // pos_ 在起始引号上；返回两个引号之间的原文（转义留给 StringPool 按需处理），
+    // 读到行尾还没有结束引号时返回 false
+    bool readStringLiteral(std::string_view& literal);
+
+    // 从 pos_ 开始读一个单词（数组声明 N[] 为三个）追加到 tokens
+    void lexToken(TokenBuffer<TokenCode>& tokens);
+
+
+    void registerArrayIdentifier(const std::string& identifier, int arraySize) {
+        symbolTable_[identifier] = arraySize;
+    }
+};
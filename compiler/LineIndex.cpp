@@ -0,0 +1,86 @@
+﻿#include "LineIndex.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LINE_INDEX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    unsigned countTrailingZeros(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+}
+
+// 每次比较 16 个字节，得到换行符和 UTF-8 后续字节位置的位掩码，再逐个取出置位的位
+void LineIndex::build() const {
+    if (built_) {
+        return;
+    }
+    lineStarts_.clear();
+    lineStarts_.push_back(0);
+    continuations_.clear();
+
+    const char* data = source_.data();
+    std::size_t size = source_.size();
+    std::size_t i = 0;
+#ifdef LINE_INDEX_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i topBits = _mm_set1_epi8(static_cast<char>(0xc0));
+    const __m128i continuation = _mm_set1_epi8(static_cast<char>(0x80));
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        while (mask != 0) {
+            lineStarts_.push_back(static_cast<std::uint32_t>(i + countTrailingZeros(mask) + 1));
+            mask &= mask - 1;
+        }
+        // 最高位全为 0 的块是纯 ASCII，不用再找后续字节
+        if (_mm_movemask_epi8(chunk) != 0) {
+            mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(chunk, topBits), continuation)));
+            while (mask != 0) {
+                continuations_.push_back(static_cast<std::uint32_t>(i + countTrailingZeros(mask)));
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (data[i] == '\n') {
+            lineStarts_.push_back(static_cast<std::uint32_t>(i + 1));
+        }
+        else if ((static_cast<unsigned char>(data[i]) & 0xc0) == 0x80) {
+            continuations_.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    built_ = true;
+}
+
+SourceLocation LineIndex::locate(std::size_t offset) const {
+    build();
+    if (offset > source_.size()) {
+        return {};
+    }
+    std::uint32_t target = static_cast<std::uint32_t>(offset);
+    auto next = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), target);
+    std::uint32_t lineStart = *(next - 1);
+
+    // 列号 = 行首到 offset 的字节数减去其中的 UTF-8 后续字节数
+    std::size_t skipped = 0;
+    if (!continuations_.empty()) {
+        skipped = std::lower_bound(continuations_.begin(), continuations_.end(), target) -
+            std::lower_bound(continuations_.begin(), continuations_.end(), lineStart);
+    }
+    int column = static_cast<int>(target - lineStart - skipped) + 1;
+    return { static_cast<int>(next - lineStarts_.begin()), column };
+}
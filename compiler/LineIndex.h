@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// 源程序中的位置，行号和列号都从 1 开始；0 表示位置未知
+struct SourceLocation {
+    int line = 0;
+    int column = 0;
+};
+
+// 换行索引：单词只记录在源文本中的字节偏移，需要报告位置时才换算成行列号。
+// 第一次 locate 时扫描一遍源文本记下每行的起始偏移和 UTF-8 后续字节的偏移，之后每次查询只做二分查找。
+// 列号按 UTF-8 字符计数，中文注释或标识符后面的列号也是准确的。
+// 只按 '\n' 分行，CRLF 中的 '\r' 在行尾，不影响行号和列号。
+//
+// 索引延迟建立，第一次 locate 会修改内部状态，不要在多个线程中同时对同一个对象做第一次查询
+class LineIndex {
+public:
+    LineIndex() = default;
+    explicit LineIndex(std::string_view source) : source_(source) {}
+
+    // 换一份源文本，保留已分配的容量
+    void reset(std::string_view source) {
+        source_ = source;
+        lineStarts_.clear();
+        continuations_.clear();
+        built_ = false;
+    }
+
+    SourceLocation locate(std::size_t offset) const;
+
+    std::size_t lineCount() const {
+        build();
+        return lineStarts_.size();
+    }
+
+private:
+    void build() const;
+
+    std::string_view source_;
+    mutable std::vector<std::uint32_t> lineStarts_;
+    mutable std::vector<std::uint32_t> continuations_;   // 10xxxxxx 字节的偏移，纯 ASCII 源文本为空
+    mutable bool built_ = false;
+};
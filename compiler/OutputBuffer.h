@@ -0,0 +1,159 @@
+﻿#pragma once
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// 带缓冲的输出：先在一块可复用的大缓冲区里格式化，写满或显式 flush 时才调用 write/writev
+// 不带文件描述符时只在内存中累积，可通过 view() 取出结果
+class OutputBuffer {
+public:
+    static constexpr std::size_t kDefaultCapacity = 64 * 1024;
+
+    // 内存模式
+    OutputBuffer() { buffer_.reserve(kDefaultCapacity); }
+
+    // 直接写到已打开的文件描述符（例如标准输出 1），不负责关闭
+    explicit OutputBuffer(int fd, std::size_t capacity = kDefaultCapacity) : fd_(fd) {
+        buffer_.reserve(capacity);
+    }
+
+    ~OutputBuffer() {
+        close();
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    // 打开（截断）文件并直接写入其文件描述符
+    bool open(const std::string& filename) {
+        close();
+#ifdef _WIN32
+        fd_ = ::_open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        fd_ = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+        ownsFd_ = fd_ >= 0;
+        failed_ = fd_ < 0;
+        return fd_ >= 0;
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+    bool good() const { return !failed_; }
+
+    OutputBuffer& append(std::string_view text) {
+        if (fd_ >= 0 && buffer_.size() + text.size() > buffer_.capacity()) {
+            if (text.size() >= buffer_.capacity() / 2) {
+                // 大块数据不再复制，与缓冲区中已有内容一起用一次 writev 写出
+                writeAll(text);
+                return *this;
+            }
+            flush();
+        }
+        buffer_.insert(buffer_.end(), text.begin(), text.end());
+        return *this;
+    }
+
+    OutputBuffer& append(char c) {
+        if (fd_ >= 0 && buffer_.size() == buffer_.capacity()) {
+            flush();
+        }
+        buffer_.push_back(c);
+        return *this;
+    }
+
+    template <typename Int>
+    OutputBuffer& appendInt(Int value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        return append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+    }
+
+    OutputBuffer& operator<<(std::string_view text) { return append(text); }
+    OutputBuffer& operator<<(const char* text) { return append(std::string_view(text)); }
+    OutputBuffer& operator<<(const std::string& text) { return append(std::string_view(text)); }
+    OutputBuffer& operator<<(char c) { return append(c); }
+
+    template <typename Int, typename = std::enable_if_t<std::is_integral_v<Int> && !std::is_same_v<Int, char> && !std::is_same_v<Int, bool>>>
+    OutputBuffer& operator<<(Int value) { return appendInt(value); }
+
+    // 内存模式下已累积的内容；文件模式下是尚未写出的部分
+    std::string_view view() const { return std::string_view(buffer_.data(), buffer_.size()); }
+
+    // 清空内容但保留容量，便于重复使用
+    void clear() { buffer_.clear(); }
+
+    bool flush() {
+        if (fd_ >= 0 && !buffer_.empty()) {
+            writeAll(std::string_view());
+        }
+        return !failed_;
+    }
+
+    bool close() {
+        bool ok = flush();
+        if (ownsFd_) {
+#ifdef _WIN32
+            ::_close(fd_);
+#else
+            ::close(fd_);
+#endif
+        }
+        fd_ = -1;
+        ownsFd_ = false;
+        return ok;
+    }
+
+private:
+    std::vector<char> buffer_;
+    int fd_ = -1;
+    bool ownsFd_ = false;
+    bool failed_ = false;
+
+    // 写出缓冲区内容以及紧随其后的 tail，处理部分写入
+    void writeAll(std::string_view tail) {
+        const char* head = buffer_.data();
+        std::size_t headSize = buffer_.size();
+        while (!failed_ && headSize + tail.size() > 0) {
+#ifdef _WIN32
+            std::string_view chunk = headSize ? std::string_view(head, headSize) : tail;
+            int written = ::_write(fd_, chunk.data(), static_cast<unsigned>(chunk.size()));
+#else
+            iovec parts[2];
+            int count = 0;
+            if (headSize) {
+                parts[count++] = { const_cast<char*>(head), headSize };
+            }
+            if (!tail.empty()) {
+                parts[count++] = { const_cast<char*>(tail.data()), tail.size() };
+            }
+            ssize_t written = count == 1 ? ::write(fd_, parts[0].iov_base, parts[0].iov_len) : ::writev(fd_, parts, count);
+#endif
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                failed_ = true;
+                break;
+            }
+            std::size_t n = static_cast<std::size_t>(written);
+            std::size_t fromHead = n < headSize ? n : headSize;
+            head += fromHead;
+            headSize -= fromHead;
+            tail.remove_prefix(n - fromHead);
+        }
+        buffer_.clear();
+    }
+};
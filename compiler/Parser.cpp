@@ -0,0 +1,343 @@
+﻿#include "Parser.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+NodeId Parser::parse() {
+    if (tokens.is(currentIndex, TokenCode::Keyword) && tokens.value(currentIndex) == "if") {
+        return parseIfStatement();
+    }
+    NodeId statement;
+    if (tokens.is(currentIndex, TokenCode::Print)) {
+        // print 表达式 ;
+        currentIndex++;
+        statement = parseExpression();
+        if (statement != kNoNode) {
+            statement = ast.addPrint(statement);
+        }
+    }
+    else {
+        statement = parseExpression();
+    }
+    // 不含运算符的语句（如 a = 1 ;）的分号不会在 parseExpression 中被跳过
+    if (statement != kNoNode && tokens.is(currentIndex, TokenCode::Delimiter) && tokens.value(currentIndex) == ";") {
+        currentIndex++;
+    }
+    return statement;
+}
+
+void Parser::parseProgram() {
+    while (!atEnd()) {
+        NodeId statement = parse();
+        if (statement == kNoNode) {
+            break;  // 出错后不再继续
+        }
+        ast.statements().push_back(statement);
+    }
+}
+
+void Parser::error(const std::string& message) {
+    std::string text = message;
+    if (lines && !tokens.empty()) {
+        // 出错的单词，已经读完时取最后一个单词的末尾；位置插在 "Syntax error" 之后
+        std::size_t offset = currentIndex < tokens.size() ? tokens.offset(currentIndex) : tokens.offset(tokens.size() - 1);
+        if (currentIndex >= tokens.size() && offset != tokens.kNoOffset) {
+            offset += tokens.value(tokens.size() - 1).size();
+        }
+        SourceLocation at = offset == tokens.kNoOffset ? SourceLocation() : lines->locate(offset);
+        std::size_t colon = text.find(':');
+        if (at.line > 0 && colon != std::string::npos) {
+            text.insert(colon, " at " + std::to_string(at.line) + ":" + std::to_string(at.column));
+        }
+    }
+    if (diagnostics) {
+        diagnostics->push_back(text);
+    }
+    else {
+        std::cerr << text << std::endl;
+    }
+}
+
+NodeId Parser::parseIfStatement() {
+    if (tokens.is(currentIndex, TokenCode::Keyword) &&
+        tokens.value(currentIndex) == "if") {
+        currentIndex++; // 移动到下一个标记
+
+        // 解析条件表达式 ( ... )
+        if (!isDelimiter("(")) {
+            error("Syntax error: Expected '(' after if");
+            return kNoNode;
+        }
+        currentIndex++;
+        NodeId condition = parseCondition();
+        if (condition == kNoNode) {
+            error("Syntax error: Invalid condition in if statement");
+            return kNoNode;
+        }
+        if (!isDelimiter(")")) {
+            error("Syntax error: Expected ')' after if condition");
+            return kNoNode;
+        }
+        currentIndex++;
+
+        //解析if分支
+        NodeId ifBranch = parseBranch();
+        if (ifBranch == kNoNode) {
+            error("Syntax error: Missing if branch in if statement");
+            return kNoNode;
+        }
+
+        // 解析else分支
+        NodeId elseBranch = kNoNode;
+        if (tokens.is(currentIndex, TokenCode::Keyword) &&
+            tokens.value(currentIndex) == "else") {
+            currentIndex++; // 移动到下一个标记
+
+            elseBranch = parseBranch();
+            if (elseBranch == kNoNode) {
+                error("Syntax error: Missing else branch in if statement");
+                return kNoNode;
+            }
+        }
+
+        return ast.addIfElse(condition, ifBranch, elseBranch);
+    }
+
+    // 如果当前标记不是if关键字，则返回空节点
+    return kNoNode;
+}
+
+NodeId Parser::parseBranch() {
+    if (!isDelimiter("{")) {
+        // 单条语句，也可以是嵌套的 if
+        return parse();
+    }
+    currentIndex++;
+    std::vector<NodeId> statements;
+    while (!isDelimiter("}")) {
+        if (atEnd()) {
+            error("Syntax error: Expected '}'");
+            return kNoNode;
+        }
+        NodeId statement = parse();
+        if (statement == kNoNode) {
+            return kNoNode;
+        }
+        statements.push_back(statement);
+    }
+    currentIndex++;
+    return ast.addBlock(statements);
+}
+
+NodeId Parser::parseCondition() {
+    // 条件：表达式 [ 比较运算符 表达式 ]，比较运算的优先级最低
+    NodeId left = parseExpression();
+    if (left == kNoNode) {
+        return kNoNode;
+    }
+    if (tokens.is(currentIndex, TokenCode::Operator) && isComparisonOperator(tokens.value(currentIndex))) {
+        char op = operatorFromText(tokens.value(currentIndex));
+        currentIndex++;
+        NodeId right = parseExpression();
+        if (right == kNoNode) {
+            return kNoNode;
+        }
+        left = ast.addBinaryOp(op, left, right);
+    }
+    return left;
+}
+
+NodeId Parser::parseExpression() {
+
+    NodeId left = parseTerm();
+    if (left == kNoNode) {
+        return kNoNode;
+    }
+
+    while (tokens.is(currentIndex, TokenCode::Operator) && !isComparisonOperator(tokens.value(currentIndex))) {
+        char op = tokens.value(currentIndex)[0];
+        currentIndex++;
+        NodeId right = parseTerm();
+        if (right == kNoNode) {
+            return kNoNode;
+        }
+        left = ast.addBinaryOp(op, left, right);
+        // 处理分号；右括号留给 parseTerm 匹配
+        if (tokens.is(currentIndex, TokenCode::Delimiter)) {
+            if (tokens.value(currentIndex) == ";") {
+                currentIndex++;
+            }
+            break;  // 遇到分隔符，结束表达式解析
+        }
+    }
+
+
+    return left;
+}
+
+NodeId Parser::parseTerm() {
+    if (tokens.is(currentIndex, TokenCode::Integer)) {
+        std::string_view valueStr = tokens.value(currentIndex);
+
+
+        std::string value;
+        if (valueStr.size() >= 2 && valueStr.front() == '"' && valueStr.back() == '"') {
+            value = valueStr.substr(1, valueStr.size() - 2);
+        }
+        else {
+            value = valueStr;
+        }
+
+        int intValue = 0;
+        if (std::from_chars(value.data(), value.data() + value.size(), intValue).ec != std::errc()) {
+            error("Syntax error: integer " + value + " is out of range");
+            return kNoNode;
+        }
+
+        currentIndex++;
+        if (isDelimiter("[")) {
+            // 数组声明 N[]
+            currentIndex++;
+            if (!isDelimiter("]")) {
+                error("Syntax error: Expected ']' in array declaration");
+                return kNoNode;
+            }
+            currentIndex++;
+            return ast.addArrayNew(intValue);
+        }
+        return ast.addInt(intValue);
+    }
+    else if (tokens.is(currentIndex, TokenCode::Identifier)) {
+        std::string_view identifier = tokens.value(currentIndex);
+        currentIndex++;
+
+        if (isDelimiter("[")) {
+            // 数组元素 a[i]，或者给数组元素赋值 a[i] = v
+            currentIndex++;
+            NodeId index = parseExpression();
+            if (index == kNoNode) {
+                return kNoNode;
+            }
+            if (!isDelimiter("]")) {
+                error("Syntax error: Expected ']'");
+                return kNoNode;
+            }
+            currentIndex++;
+            if (currentIndex < tokens.size() && tokens.value(currentIndex) == "=") {
+                currentIndex++;
+                NodeId value = parseExpression();
+                if (value == kNoNode) {
+                    return kNoNode;
+                }
+                return ast.addStore(identifier, index, value);
+            }
+            return ast.addIndex(identifier, index);
+        }
+
+        if (currentIndex < tokens.size() && tokens.value(currentIndex) == "=") {
+            currentIndex++;
+            NodeId expression = parseExpression();
+            if (expression == kNoNode) {
+                return kNoNode;
+            }
+            return ast.addAssignment(identifier, expression);
+        }
+        else {
+            // 变量引用
+            return ast.addVariable(identifier);
+        }
+    }
+    else if (tokens.is(currentIndex, TokenCode::StringLiteral)) {
+        // 词法分析时已经登记到常量池的直接用下标，从 tokens.txt 读入的在这里登记（复制一份原文）
+        std::uint32_t literal = tokens.literal(currentIndex);
+        if (literal == tokens.kNoLiteral) {
+            std::string_view quoted = tokens.value(currentIndex);
+            literal = ast.strings().intern(quoted.substr(1, quoted.size() - 2), true);
+        }
+        currentIndex++;
+        return ast.addString(literal);
+    }
+    else if (currentIndex < tokens.size() && tokens.value(currentIndex) == "(") {
+        currentIndex++;
+        NodeId expression = parseExpression();
+        if (expression == kNoNode) {
+            return kNoNode;
+        }
+        if (currentIndex >= tokens.size() || tokens.value(currentIndex) != ")") {
+            error("Syntax error: Expected ')'");
+            return kNoNode;
+        }
+        currentIndex++;
+        return expression;
+    }
+    else {
+        error("Syntax error: Expected integer or identifier");
+        return kNoNode;
+    }
+}
+
+TokenBuffer<TokenCode> readTokensFromFile(const std::string& filename) {
+    TokenBuffer<TokenCode> tokens;
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return tokens;
+    }
+    std::string line;
+
+    while (std::getline(file, line)) {
+        // 值在 ," 与行末的 " 之间，字符串常量中可以有空格
+        std::stringstream ss(line);
+        std::string typeStr;
+        ss >> typeStr;
+        std::size_t comma = line.find(",\"");
+        std::string value = comma == std::string::npos ? "" : line.substr(comma + 1);
+
+        // 去除空格
+        typeStr.erase(std::remove_if(typeStr.begin(), typeStr.end(), ::isspace), typeStr.end());
+
+        // 解析 token 类型
+        size_t start = typeStr.find("::") + 2;
+        size_t end = typeStr.find_last_of('>');
+        std::string tokenType = typeStr.substr(start, end - start);
+
+        TokenCode type;
+        if (tokenType == "Integer") {
+            type = TokenCode::Integer;
+        }
+        else if (tokenType == "Operator") {
+            type = TokenCode::Operator;
+        }
+        else if (tokenType == "Keyword") {
+            type = TokenCode::Keyword;
+        }
+        else if (tokenType == "Identifier") {
+            type = TokenCode::Identifier;
+        }
+        else if (tokenType == "Delimiter") {
+            type = TokenCode::Delimiter;
+        }
+        else if (tokenType == "Print") {
+            type = TokenCode::Print;
+        }
+        else if (tokenType == "StringLiteral") {
+            type = TokenCode::StringLiteral;
+        }
+        else {
+            std::cerr << "Invalid token type: " << tokenType << std::endl;
+            continue;
+        }
+
+        // 解析 token 值
+        size_t valueStart = value.find('"') + 1;
+        size_t valueEnd = value.find_last_of('"');
+        std::string tokenValue = value.substr(valueStart, valueEnd - valueStart);
+
+        tokens.pushOwned(type, tokenValue);
+    }
+
+    return tokens;
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include "AST.h"
+#include "LineIndex.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+
+// 语法分析器类
+class Parser {
+public:
+    // 语法树节点建立在 ast 中
+    Parser(const TokenBuffer<TokenCode>& tokens, Ast& ast) : tokens(tokens), ast(ast), currentIndex(0) {}
+
+    // 每次调用解析一条语句，返回语句的根节点；出错时返回 kNoNode
+    NodeId parse();
+
+    // 解析全部语句，根节点依次追加到 ast.statements()，遇到语法错误时停止
+    void parseProgram();
+
+    bool atEnd() const {
+        return currentIndex >= tokens.size();
+    }
+
+    // 语法错误默认打印到 std::cerr；设置后改为追加到 diagnostics
+    void setDiagnostics(std::vector<std::string>* diagnostics) {
+        this->diagnostics = diagnostics;
+    }
+
+    // 设置后语法错误带上出错单词的行列号
+    void setLineIndex(const LineIndex* lines) {
+        this->lines = lines;
+    }
+
+private:
+    NodeId parseIfStatement();
+    NodeId parseBranch();
+    NodeId parseCondition();
+    NodeId parseExpression();
+    NodeId parseTerm();
+    void error(const std::string& message);
+    bool isDelimiter(std::string_view value) const {
+        return tokens.is(currentIndex, TokenCode::Delimiter) && tokens.value(currentIndex) == value;
+    }
+
+    const TokenBuffer<TokenCode>& tokens;
+    Ast& ast;
+    size_t currentIndex;
+    std::vector<std::string>* diagnostics = nullptr;
+    const LineIndex* lines = nullptr;
+};
+
+// 读取词法分析输出的 tokens.txt
+TokenBuffer<TokenCode> readTokensFromFile(const std::string& filename);
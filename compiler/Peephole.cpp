@@ -0,0 +1,339 @@
+﻿#include "Peephole.h"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+void PeepholeStats::add(const PeepholeStats& other) {
+    before += other.before;
+    after += other.after;
+    for (const auto& hit : other.hits) {
+        hits[hit.first] += hit.second;
+    }
+}
+
+void PeepholeStats::clear() {
+    before = 0;
+    after = 0;
+    hits.clear();
+}
+
+std::string_view registerFamily(std::string_view word) {
+    static const char* const families[][5] = {
+        { "rax", "eax", "ax", "al", "ah" },
+        { "rbx", "ebx", "bx", "bl", "bh" },
+        { "rcx", "ecx", "cx", "cl", "ch" },
+        { "rdx", "edx", "dx", "dl", "dh" },
+        { "rsi", "esi", "si", "sil", "" },
+        { "rdi", "edi", "di", "dil", "" },
+        { "rsp", "esp", "sp", "spl", "" },
+        { "rbp", "ebp", "bp", "bpl", "" },
+    };
+    for (const auto& family : families) {
+        for (const char* name : family) {
+            if (*name && word == name) {
+                return family[0];
+            }
+        }
+    }
+    // r8~r15 及其 d/w/b 形式，xmm0~xmm15
+    if (word.size() >= 2 && word[0] == 'r' && std::isdigit(static_cast<unsigned char>(word[1]))) {
+        std::size_t end = 1;
+        while (end < word.size() && std::isdigit(static_cast<unsigned char>(word[end]))) {
+            end++;
+        }
+        std::string_view rest = word.substr(end);
+        if (rest.empty() || rest == "d" || rest == "w" || rest == "b") {
+            return word.substr(0, end);
+        }
+    }
+    if (word.compare(0, 3, "xmm") == 0) {
+        return word;
+    }
+    return {};
+}
+
+namespace {
+    // operand 中是否用到 family 所在的寄存器（包括作为地址的一部分）
+    bool mentions(std::string_view operand, std::string_view family) {
+        std::size_t pos = 0;
+        while (pos < operand.size()) {
+            while (pos < operand.size() && !std::isalnum(static_cast<unsigned char>(operand[pos]))) {
+                pos++;
+            }
+            std::size_t start = pos;
+            while (pos < operand.size() && (std::isalnum(static_cast<unsigned char>(operand[pos])) || operand[pos] == '_')) {
+                pos++;
+            }
+            if (pos > start && registerFamily(operand.substr(start, pos - start)) == family) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isImmediate(std::string_view operand) {
+        return !operand.empty() && (std::isdigit(static_cast<unsigned char>(operand[0])) || operand[0] == '-');
+    }
+
+    bool isRegister(std::string_view operand) {
+        return !registerFamily(operand).empty();
+    }
+
+    bool isMemory(std::string_view operand) {
+        return !isImmediate(operand) && !isRegister(operand);
+    }
+
+    bool isStackOperation(const Instruction& instruction) {
+        return instruction.count == 0 &&
+            (instruction.is("add") || instruction.is("sub") || instruction.is("mul") || instruction.is("div"));
+    }
+
+    // 只读写操作数、不碰栈和控制流的指令，第一个操作数为目的操作数
+    bool isSimple(const Instruction& instruction) {
+        static const char* const simple[] = { "mov", "movzx", "add", "sub", "imul", "xor", "and", "or", "neg", "cmp", "lea" };
+        if (instruction.count == 0) {
+            return false;
+        }
+        for (const char* op : simple) {
+            if (instruction.is(op)) {
+                return true;
+            }
+        }
+        return instruction.op.compare(0, 3, "set") == 0 || instruction.op.compare(0, 4, "cmov") == 0;
+    }
+
+    // 指令是否改写了 operand 读到的寄存器或内存
+    bool clobbers(const Instruction& instruction, std::string_view operand) {
+        if (instruction.is("cmp")) {
+            return false;
+        }
+        std::string_view target = instruction.operands[0];
+        std::string_view family = registerFamily(target);
+        if (!family.empty()) {
+            return mentions(operand, family);
+        }
+        // 写内存：保守地认为与任何内存操作数都可能重叠
+        return isMemory(operand);
+    }
+
+    // mov Y, X；两边都是内存时经过 r11d
+    void move(InstructionList& out, const std::string& target, const std::string& source) {
+        if (isMemory(target) && isMemory(source)) {
+            out.emplace_back("mov", "r11d", source);
+            out.emplace_back("mov", target, "r11d");
+        }
+        else {
+            out.emplace_back("mov", target, source);
+        }
+    }
+
+    bool pushPop(const Instruction* window, InstructionList& out) {
+        const Instruction& push = window[0];
+        const Instruction& pop = window[1];
+        if (!push.is("push") || !pop.is("pop")) {
+            return false;
+        }
+        if (push.operands[0] != pop.operands[0]) {
+            move(out, pop.operands[0], push.operands[0]);
+        }
+        return true;
+    }
+
+    void multiply(InstructionList& out, const std::string& operand) {
+        if (isImmediate(operand)) {
+            out.emplace_back("imul", "eax", "eax", operand);
+        }
+        else {
+            out.emplace_back("imul", "eax", operand);
+        }
+    }
+
+    bool fold(const Instruction* window, InstructionList& out) {
+        const Instruction& left = window[0];
+        const Instruction& right = window[1];
+        const Instruction& operation = window[2];
+        if (!left.is("push") || !right.is("push") || !isStackOperation(operation)) {
+            return false;
+        }
+        const std::string& x = left.operands[0];
+        const std::string& y = right.operands[0];
+        if (y == "eax") {
+            // 右操作数刚算到 eax 里：加法、乘法交换操作数，减法取反后再加
+            if (mentions(x, "rax") || mentions(x, "rcx")) {
+                return false;
+            }
+            if (operation.is("add")) {
+                out.emplace_back("add", "eax", x);
+            }
+            else if (operation.is("sub")) {
+                out.emplace_back("neg", "eax");
+                out.emplace_back("add", "eax", x);
+            }
+            else if (operation.is("mul")) {
+                multiply(out, x);
+            }
+            else {
+                out.emplace_back("mov", "ecx", "eax");
+                out.emplace_back("mov", "eax", x);
+                out.emplace_back("cdq");
+                out.emplace_back("idiv", "ecx");
+            }
+            out.emplace_back("push", "eax");
+            return true;
+        }
+        if (mentions(y, "rax") || (operation.is("div") && mentions(y, "rdx"))) {
+            return false;
+        }
+
+        out.emplace_back("mov", "eax", x);
+        if (operation.is("add") || operation.is("sub")) {
+            out.emplace_back(operation.op, "eax", y);
+        }
+        else if (operation.is("mul")) {
+            multiply(out, y);
+        }
+        else {
+            out.emplace_back("cdq");
+            if (isImmediate(y)) {
+                out.emplace_back("mov", "ecx", y);
+                out.emplace_back("idiv", "ecx");
+            }
+            else {
+                out.emplace_back("idiv", y);
+            }
+        }
+        out.emplace_back("push", "eax");
+        return true;
+    }
+
+    // push 往后移，直到碰上用栈的指令，让 push-pop、fold 有机会匹配
+    bool sinkPush(const Instruction* window, InstructionList& out) {
+        const Instruction& push = window[0];
+        const Instruction& next = window[1];
+        if (!push.is("push") || !isSimple(next) || clobbers(next, push.operands[0])) {
+            return false;
+        }
+        out.push_back(next);
+        out.push_back(push);
+        return true;
+    }
+
+    // 按约定 eax、edx 装入后只给紧跟着的 cmp 使用，可以把装入的值直接作为 cmp 的操作数
+    bool compareOperand(const Instruction* window, InstructionList& out) {
+        const Instruction& load = window[0];
+        const Instruction& compare = window[1];
+        if (!load.is("mov") || !compare.is("cmp") || (load.operands[0] != "eax" && load.operands[0] != "edx")) {
+            return false;
+        }
+        const std::string& target = load.operands[0];
+        std::string_view family = registerFamily(target);
+        const std::string& source = load.operands[1];
+        const std::string& left = compare.operands[0];
+        const std::string& right = compare.operands[1];
+        if (right == target && !mentions(left, family) && !(isMemory(left) && isMemory(source))) {
+            out.emplace_back("cmp", left, source);
+            return true;
+        }
+        if (left == target && !mentions(right, family) && !isImmediate(source) && !(isMemory(source) && isMemory(right))) {
+            out.emplace_back("cmp", source, right);
+            return true;
+        }
+        return false;
+    }
+
+    bool selfMove(const Instruction* window, InstructionList&) {
+        return window[0].is("mov") && window[0].operands[0] == window[0].operands[1];
+    }
+
+    bool deadMove(const Instruction* window, InstructionList& out) {
+        const Instruction& first = window[0];
+        const Instruction& second = window[1];
+        if (!first.is("mov") || !second.is("mov") || first.operands[0] != second.operands[0]) {
+            return false;
+        }
+        std::string_view target = first.operands[0];
+        std::string_view family = registerFamily(target);
+        std::string_view source = second.operands[1];
+        bool reads = family.empty() ? source.find(target) != std::string_view::npos : mentions(source, family);
+        if (reads) {
+            return false;
+        }
+        out.push_back(second);
+        return true;
+    }
+}
+
+const std::vector<PeepholeRule>& defaultPeepholeRules() {
+    static const std::vector<PeepholeRule> rules = {
+        { "push-pop", 2, pushPop },
+        { "fold", 3, fold },
+        { "sink-push", 2, sinkPush },
+        { "cmp-operand", 2, compareOperand },
+        { "self-mov", 1, selfMove },
+        { "dead-mov", 2, deadMove },
+    };
+    return rules;
+}
+
+PeepholeOptimizer::PeepholeOptimizer() {
+    for (const PeepholeRule& rule : defaultPeepholeRules()) {
+        addRule(rule);
+    }
+}
+
+void PeepholeOptimizer::addRule(const PeepholeRule& rule) {
+    rules_.push_back(rule);
+    if (rule.window > maxWindow_) {
+        maxWindow_ = rule.window;
+    }
+}
+
+void PeepholeOptimizer::optimize(InstructionList& list, PeepholeStats* stats) const {
+    if (stats) {
+        stats->before += list.size();
+    }
+    // list 本身作为待处理的缓冲区：[next, size) 是还没处理的指令，前面的位置空出来放改写结果，
+    // 处理完的指令移到 done。这样每次改写只移动窗口附近的几条指令
+    InstructionList done;
+    done.reserve(list.size());
+    InstructionList replacement;
+    std::size_t next = 0;
+    while (next < list.size()) {
+        const PeepholeRule* matched = nullptr;
+        for (const PeepholeRule& rule : rules_) {
+            replacement.clear();
+            if (list.size() - next >= rule.window && rule.apply(&list[next], replacement)) {
+                matched = &rule;
+                break;
+            }
+        }
+        if (!matched) {
+            done.push_back(std::move(list[next++]));
+            continue;
+        }
+        if (stats) {
+            stats->hits[matched->name]++;
+        }
+
+        // 改写可能让前面的指令组成新的模式，退回一个窗口与改写结果一起重新匹配
+        next += matched->window;
+        std::size_t back = std::min(done.size(), maxWindow_ - 1);
+        std::size_t need = replacement.size() + back;
+        if (need > next) {
+            std::size_t grow = need - next + list.size();
+            list.insert(list.begin(), grow, Instruction());
+            next += grow;
+        }
+        for (std::size_t i = replacement.size(); i-- > 0;) {
+            list[--next] = std::move(replacement[i]);
+        }
+        for (std::size_t i = 0; i < back; ++i) {
+            list[--next] = std::move(done.back());
+            done.pop_back();
+        }
+    }
+    list.swap(done);
+    if (stats) {
+        stats->after += list.size();
+    }
+}
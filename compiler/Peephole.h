@@ -0,0 +1,64 @@
+﻿#pragma once
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Instruction.h"
+
+// 窥孔优化
+//
+// convertToAssembly 先按栈式机器生成代码：操作数压栈，运算指令（无操作数的 add/sub/mul/div）
+// 弹出两个值再压入结果，赋值弹出到变量。窥孔优化在一个基本块的指令序列上滑动窗口，
+// 把这些栈操作改写成寄存器形式。
+//
+// 规则依赖栈式代码的约定：eax、ecx、edx 只在 cmp、select、下标等局部序列中使用，
+// 不会跨过 push/pop 或栈式运算保存值，因此规则可以直接把它们当作临时寄存器。
+
+// 通用寄存器的各种宽度归到同一个名字，例如 eax、ax、al 都是 rax，r8d 是 r8；不是寄存器时返回空
+std::string_view registerFamily(std::string_view word);
+
+// 一次或多次优化的统计
+struct PeepholeStats {
+    std::size_t before = 0;                    // 优化前的指令数
+    std::size_t after = 0;                     // 优化后的指令数
+    std::map<std::string, std::size_t> hits;   // 每条规则的命中次数
+
+    void add(const PeepholeStats& other);
+    void clear();
+};
+
+// 规则：在连续的 window 条指令上匹配，匹配时把替换这几条的指令追加到 replacement（可以为空）并返回 true。
+// 每次改写都必须减少压栈次数，或者不增加压栈次数而把 push 往后移，保证优化会结束
+struct PeepholeRule {
+    const char* name;
+    std::size_t window;
+    bool (*apply)(const Instruction* window, InstructionList& replacement);
+};
+
+// 默认规则：
+//   push-pop     push X; pop Y              -> mov Y, X
+//   fold         push X; push Y; add        -> mov eax, X; add eax, Y; push eax（sub/mul/div 同理，
+//                                              Y 为 eax 时 add eax, X 等）
+//   sink-push    push X; I                  -> I; push X（I 不用栈、不改写 X 时）
+//   cmp-operand  mov eax, X; cmp eax, Y     -> cmp X, Y（edx 作为右操作数同理）
+//   self-mov     mov X, X                   -> 删除
+//   dead-mov     mov A, X; mov A, Y         -> mov A, Y（Y 不读 A 时）
+const std::vector<PeepholeRule>& defaultPeepholeRules();
+
+class PeepholeOptimizer {
+public:
+    PeepholeOptimizer();
+
+    // 追加一条规则，按加入顺序尝试
+    void addRule(const PeepholeRule& rule);
+
+    const std::vector<PeepholeRule>& rules() const { return rules_; }
+
+    // 优化一个基本块内顺序执行的指令，统计累加到 stats（可以为空）
+    void optimize(InstructionList& list, PeepholeStats* stats = nullptr) const;
+
+private:
+    std::vector<PeepholeRule> rules_;
+    std::size_t maxWindow_ = 0;
+};
@@ -0,0 +1,414 @@
+﻿#include "SemanticAnalyzer.h"
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include "AstWalk.h"
+#include "OutputBuffer.h"
+
+std::vector<std::string> SemanticAnalyzer::generateCode() {
+    std::vector<std::string> code;
+    if (root != kNoNode) {
+        generateCode(ast, root, code);
+    }
+    return code;
+}
+
+namespace {
+    // 逆波兰式生成。后序遍历正好是逆波兰式的顺序：操作数在前，运算符在后。
+    // 条件语句展开为跳转：
+    //   条件 .Lk jz if分支 .Lk+1 jmp .Lk: else分支 .Lk+1:
+    // 两个分支都只是给同一个变量赋整数或变量值时没有副作用，两边都求值也没有关系，
+    // 生成无分支的 select：条件 if值 else值 select 变量 =
+    struct RpnEmitter {
+        const Ast& ast;
+        OutputBuffer& line;
+        std::size_t statement;  // 语句序号，保证不同语句的标号不重复
+        CodeGenContext& context;
+        unsigned nextLabel = 0;
+        std::vector<unsigned> labels{};  // 每个未结束的条件语句的 else 标号，结束标号为其后一个
+        NodeId declaration = kNoNode;  // 正在声明的数组的 ArrayNew 节点
+        NodeId printed = kNoNode;      // 正在输出的 print 语句的操作数
+        bool vector = false;           // 正在生成整个数组的逐元素赋值
+        int expression = 0;            // 外层赋值、输出语句和条件的层数，不为 0 时在表达式之中
+
+        void error(const std::string& message) {
+            context.errors++;
+            if (context.diagnostics) {
+                context.diagnostics->push_back(message);
+            }
+            else {
+                std::cerr << message << std::endl;
+            }
+        }
+
+        // 不是数组时返回 0
+        std::uint32_t arrayLength(std::string_view name) const {
+            auto it = context.arrays.find(std::string(name));
+            return it == context.arrays.end() ? 0 : it->second;
+        }
+
+        void separate() {
+            if (!line.view().empty()) {
+                line << ' ';
+            }
+        }
+
+        void label(unsigned n) {
+            separate();
+            line << ".L" << statement << '_' << n;
+        }
+
+        // 变量名前加 @，array、vec、jz、select 之类的变量名不会被当成逆波兰式的操作
+        void name(std::string_view text) {
+            line << kRpnVariable << text;
+        }
+
+        void operand(const AstNode& node) {
+            separate();
+            if (node.kind == NodeKind::Int) {
+                line << node.value;
+            }
+            else {
+                name(ast.name(node));
+            }
+        }
+
+        // 只含一条赋值语句、右侧是整数或标量变量的分支
+        const AstNode* simpleAssignment(NodeId id) const {
+            const AstNode* node = &ast.node(id);
+            if (node->kind == NodeKind::Block && node->children[0] != kNoNode && node->children[1] == kNoNode) {
+                node = &ast.node(node->children[0]);
+            }
+            if (node->kind != NodeKind::Assignment || arrayLength(ast.name(*node))) {
+                return nullptr;
+            }
+            const AstNode& value = ast.node(node->children[0]);
+            if (value.kind == NodeKind::Int || (value.kind == NodeKind::Variable && !arrayLength(ast.name(value)))) {
+                return node;
+            }
+            return nullptr;
+        }
+
+        bool emitSelect(const AstNode& node) {
+            const AstNode* thenAssign = simpleAssignment(node.children[1]);
+            if (!thenAssign) {
+                return false;
+            }
+            const AstNode* elseAssign = nullptr;
+            if (node.children[2] != kNoNode) {
+                elseAssign = simpleAssignment(node.children[2]);
+                if (!elseAssign || ast.name(*elseAssign) != ast.name(*thenAssign)) {
+                    return false;
+                }
+            }
+            expression++;
+            walk(ast, node.children[0], *this);
+            expression--;
+            operand(ast.node(thenAssign->children[0]));
+            if (elseAssign) {
+                operand(ast.node(elseAssign->children[0]));
+            }
+            else {
+                // 没有 else 分支时变量保持原值
+                separate();
+                name(ast.name(*thenAssign));
+            }
+            separate();
+            line << "select ";
+            name(ast.name(*thenAssign));
+            line << " =";
+            return true;
+        }
+
+        // 逐元素赋值的右侧只能由整数、标量变量和同样长度的数组做四则运算组成
+        bool checkVector(NodeId value, std::string_view target, std::uint32_t length) {
+            bool ok = true;
+            walkPreOrder(ast, value, [&](NodeId, const AstNode& node) {
+                if (node.kind == NodeKind::Variable) {
+                    std::uint32_t other = arrayLength(ast.name(node));
+                    if (other != 0 && other != length) {
+                        error("Semantic error: array '" + std::string(ast.name(node)) + "' has " + std::to_string(other) +
+                            " elements but '" + std::string(target) + "' has " + std::to_string(length));
+                        ok = false;
+                    }
+                }
+                else if (node.kind != NodeKind::Int && node.kind != NodeKind::BinaryOp) {
+                    error("Semantic error: only arithmetic on arrays and scalars is supported in whole-array assignment to '" +
+                        std::string(target) + "'");
+                    ok = false;
+                }
+                else if (node.kind == NodeKind::BinaryOp && isComparison(node.op)) {
+                    error("Semantic error: comparison in whole-array assignment to '" + std::string(target) + "'");
+                    ok = false;
+                }
+            });
+            if (ok && SemanticAnalyzer::analyze(ast, value).maxDepth > kMaxVectorDepth) {
+                error("Semantic error: whole-array expression assigned to '" + std::string(target) + "' is nested too deeply");
+                ok = false;
+            }
+            return ok;
+        }
+
+        // 数组下标：常量下标在编译时检查，不再生成运行时检查
+        void index(const AstNode& node, const char* suffix) {
+            std::uint32_t length = arrayLength(ast.name(node));
+            if (length == 0) {
+                error("Semantic error: '" + std::string(ast.name(node)) + "' is not an array");
+                return;
+            }
+            separate();
+            name(ast.name(node));
+            line << ' ';
+            const AstNode& subscript = ast.node(node.children[0]);
+            if (subscript.kind == NodeKind::Int) {
+                if (subscript.value < 0 || static_cast<std::uint32_t>(subscript.value) >= length) {
+                    error("Semantic error: index " + std::to_string(subscript.value) + " is out of bounds for '" +
+                        std::string(ast.name(node)) + "' with " + std::to_string(length) + " elements");
+                }
+                line << "[]" << suffix;
+            }
+            else {
+                line << '[' << length << ']' << suffix;
+            }
+        }
+
+        bool enter(NodeId id, const AstNode& node) {
+            if ((node.kind == NodeKind::Assignment || node.kind == NodeKind::Store) && expression != 0) {
+                // 赋值不产生值，a = b = 1 中的 b = 1 不能作为 a 的右侧
+                error("Semantic error: assignment to '" + std::string(ast.name(node)) + "' can only be a statement");
+                return false;
+            }
+            if (node.kind == NodeKind::ArrayNew && id != declaration) {
+                error("Semantic error: array declaration N[] must be the whole right-hand side of an assignment");
+                return false;
+            }
+            if (node.kind == NodeKind::Print) {
+                printed = node.children[0];
+                expression++;
+                return true;
+            }
+            if (node.kind == NodeKind::String && id != printed) {
+                error("Semantic error: a string literal can only be printed");
+                return false;
+            }
+            if (node.kind == NodeKind::Assignment) {
+                const AstNode& value = ast.node(node.children[0]);
+                std::uint32_t length = arrayLength(ast.name(node));
+                if (value.kind == NodeKind::ArrayNew) {
+                    if (value.value <= 0) {
+                        error("Semantic error: array '" + std::string(ast.name(node)) + "' must have at least one element");
+                        return false;
+                    }
+                    if (length != 0) {
+                        error("Semantic error: array '" + std::string(ast.name(node)) + "' is already declared");
+                        return false;
+                    }
+                    context.arrays[std::string(ast.name(node))] = static_cast<std::uint32_t>(value.value);
+                    declaration = node.children[0];
+                }
+                else if (length != 0) {
+                    if (!checkVector(node.children[0], ast.name(node), length)) {
+                        return false;
+                    }
+                    label(nextLabel++);
+                    line << ' ' << length << " vec";
+                    vector = true;
+                }
+                expression++;
+                return true;
+            }
+            if (node.kind == NodeKind::Store) {
+                expression++;
+                return true;
+            }
+            if (node.kind != NodeKind::IfElse) {
+                return true;
+            }
+            if (context.branchless && emitSelect(node)) {
+                return false;
+            }
+            labels.push_back(nextLabel);
+            nextLabel += 2;
+            expression++;
+            return true;
+        }
+
+        void between(NodeId, const AstNode& node, int index) {
+            if (node.kind != NodeKind::IfElse) {
+                return;
+            }
+            unsigned elseLabel = labels.back();
+            if (index == 1) {
+                // 条件结束，两个分支都是语句
+                expression--;
+                label(elseLabel);
+                line << " jz";
+            }
+            else {
+                label(elseLabel + 1);
+                line << " jmp";
+                label(elseLabel);
+                line << ':';
+            }
+        }
+
+        void leave(NodeId, const AstNode& node) {
+            switch (node.kind) {
+            case NodeKind::Int:
+                operand(node);
+                break;
+            case NodeKind::Variable:
+                if (arrayLength(ast.name(node))) {
+                    if (!vector) {
+                        error("Semantic error: array '" + std::string(ast.name(node)) + "' used as a scalar");
+                        break;
+                    }
+                    separate();
+                    name(ast.name(node));
+                    line << "[]";
+                    break;
+                }
+                operand(node);
+                break;
+            case NodeKind::BinaryOp:
+                separate();
+                line << operatorText(node.op);
+                break;
+            case NodeKind::Assignment:
+                expression--;
+                separate();
+                name(ast.name(node));
+                if (vector) {
+                    line << "[] = endvec";
+                    vector = false;
+                }
+                else {
+                    line << " =";
+                }
+                break;
+            case NodeKind::ArrayNew:
+                separate();
+                line << node.value << " array";
+                break;
+            case NodeKind::String:
+                // 逆波兰式中只记常量池下标，常量本身放在汇编的数据段
+                separate();
+                line << '$' << node.value;
+                break;
+            case NodeKind::Print:
+                expression--;
+                separate();
+                line << "print";
+                break;
+            case NodeKind::Index:
+                index(node, "");
+                break;
+            case NodeKind::Store:
+                expression--;
+                index(node, "=");
+                break;
+            case NodeKind::IfElse:
+                label(node.children[2] != kNoNode ? labels.back() + 1 : labels.back());
+                line << ':';
+                labels.pop_back();
+                break;
+            default:
+                break;
+            }
+        }
+    };
+}
+
+void SemanticAnalyzer::generateCode(const Ast& ast, NodeId root, std::vector<std::string>& code, CodeGenContext& context) {
+    OutputBuffer line;
+    RpnEmitter emitter{ ast, line, code.size(), context };
+    walk(ast, root, emitter);
+    code.emplace_back(line.view());
+}
+
+void SemanticAnalyzer::generateCode(const Ast& ast, NodeId root, std::vector<std::string>& code, bool branchless) {
+    CodeGenContext context;
+    context.branchless = branchless;
+    generateCode(ast, root, code, context);
+}
+
+namespace {
+    // 按 32 位补码回绕计算，不产生有符号溢出；无法计算时返回 false
+    bool evaluate(char op, std::int32_t left, std::int32_t right, std::int32_t& result) {
+        std::uint32_t l = static_cast<std::uint32_t>(left);
+        std::uint32_t r = static_cast<std::uint32_t>(right);
+        switch (op) {
+        case '+':
+            result = static_cast<std::int32_t>(l + r);
+            return true;
+        case '-':
+            result = static_cast<std::int32_t>(l - r);
+            return true;
+        case '*':
+            result = static_cast<std::int32_t>(l * r);
+            return true;
+        case '/':
+            if (right == 0 || (left == std::numeric_limits<std::int32_t>::min() && right == -1)) {
+                return false;
+            }
+            result = left / right;
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+std::size_t SemanticAnalyzer::foldConstants(Ast& ast, NodeId root) {
+    std::size_t folded = 0;
+    // 后序遍历保证子表达式先被折叠，(1 + 2) * 3 可以一直折叠到 9
+    walkPostOrder(ast, root, [&](NodeId id, const AstNode&) {
+        AstNode& node = ast.node(id);
+        if (node.kind != NodeKind::BinaryOp) {
+            return;
+        }
+        const AstNode& left = ast.node(node.children[0]);
+        const AstNode& right = ast.node(node.children[1]);
+        if (left.kind != NodeKind::Int || right.kind != NodeKind::Int) {
+            return;
+        }
+        std::int32_t value;
+        // 逆波兰式中没有负数字面量，结果为负时保留原表达式
+        if (!evaluate(node.op, left.value, right.value, value) || value < 0) {
+            return;
+        }
+        node.kind = NodeKind::Int;
+        node.value = value;
+        node.children[0] = node.children[1] = kNoNode;
+        folded++;
+    });
+    return folded;
+}
+
+AstStats SemanticAnalyzer::analyze(const Ast& ast, NodeId root) {
+    struct Analyzer {
+        AstStats stats;
+        std::size_t depth = 0;
+
+        bool enter(NodeId, const AstNode& node) {
+            stats.nodeCount++;
+            depth++;
+            if (depth > stats.maxDepth) {
+                stats.maxDepth = depth;
+            }
+            if (node.kind == NodeKind::Assignment) {
+                stats.assignmentCount++;
+            }
+            else if (node.kind == NodeKind::Variable) {
+                stats.variableCount++;
+            }
+            return true;
+        }
+        void between(NodeId, const AstNode&, int) {}
+        void leave(NodeId, const AstNode&) { depth--; }
+    };
+
+    Analyzer analyzer;
+    walk(ast, root, analyzer);
+    return analyzer.stats;
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AST.h"
+#include "SymbolTable.h"
+
+// 逆波兰式中变量名的前缀：@a；操作（array、vec、jz、select 等）和标号（.Lk）都不以它开头
+constexpr char kRpnVariable = '@';
+
+// 逐元素运算时栈上最多同时存在的向量值（按栈深度使用 xmm0~xmm7）
+constexpr std::size_t kMaxVectorDepth = 6;
+
+// 生成中间代码时在语句之间共享的状态
+struct CodeGenContext {
+    bool branchless = true;                                  // 简单的条件赋值生成 select
+    std::unordered_map<std::string, std::uint32_t> arrays;   // 已声明的数组及其元素个数
+    std::vector<std::string>* diagnostics = nullptr;         // 语义错误；为空时打印到 std::cerr
+    std::size_t errors = 0;
+};
+
+// 语法树的统计信息
+struct AstStats {
+    std::size_t nodeCount = 0;
+    std::size_t maxDepth = 0;
+    std::size_t assignmentCount = 0;
+    std::size_t variableCount = 0;  // 变量引用次数
+};
+
+// 语义分析器类
+class SemanticAnalyzer {
+public:
+    SemanticAnalyzer(const Ast& ast, NodeId root) : ast(ast), root(root) {}
+
+    // 生成中间代码（逆波兰式）
+    std::vector<std::string> generateCode();
+
+    // 为 root 所在的语法树生成一行逆波兰式，追加到 code。
+    // 条件语句生成 jz/jmp 跳转；branchless 为 true 时，简单的条件赋值改为生成 select。
+    // 数组：a = N[] 生成 N array @a =；下标已知在范围内时生成 @a []，否则生成带检查的 @a [N]；
+    // 整个数组的逐元素赋值生成 .Lk N vec ... @c[] = endvec，由汇编阶段展开成 SIMD 循环
+    static void generateCode(const Ast& ast, NodeId root, std::vector<std::string>& code, CodeGenContext& context);
+    static void generateCode(const Ast& ast, NodeId root, std::vector<std::string>& code, bool branchless = true);
+
+    // 常量折叠：两个操作数都是整数的运算直接替换成结果，返回折叠的运算个数
+    static std::size_t foldConstants(Ast& ast, NodeId root);
+
+    static AstStats analyze(const Ast& ast, NodeId root);
+
+    // 以下两个在 Dataflow.cpp 中，作用于整个编译单元的所有语句
+
+    // 建立符号表并统计每个变量的赋值和读取次数；变量在所有路径上都赋值之前就被读取时给出警告
+    // （变量初值为 0，警告不算错误），每个变量只报告一次。返回警告的个数
+    static std::size_t checkAssignments(const Ast& ast, SymbolTable& symbols, std::vector<std::string>* diagnostics = nullptr);
+
+    // 活跃变量分析：删除结果在被读取之前就被覆盖的赋值，以及因此不再有用的元素赋值和空的条件语句。
+    // keepFinalValues 为 true 时程序结束时所有变量都算活跃（运行时会输出它们的值），
+    // 否则之后不再读取的赋值也删除。右侧可能在运行时出错（除数不是非零常量、下标不是常量）的赋值保留，
+    // checkAssignments 发现生成代码时会报语义错误的语句也保留，错误不会因为语句被删除而不报告。
+    // symbols 由 checkAssignments 对同一棵语法树建立。删除块中的语句时改写 Block 链，
+    // 单独作为分支的语句改成空块。返回删除的语句个数
+    static std::size_t eliminateDeadAssignments(Ast& ast, const SymbolTable& symbols, bool keepFinalValues = true);
+
+private:
+    const Ast& ast;
+    NodeId root;
+};
@@ -0,0 +1,108 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+// 单生产者单消费者的有界无锁环形队列
+//
+// 生产者只写 tail_，消费者只写 head_，两者放在不同的缓存行上，互不干扰。
+// Capacity 必须是 2 的幂；队列满或空时 push/pop 在条件变量上睡眠，不占用对方的时间片，
+// 只有对方正在等待时才加锁唤醒它。close 之后 pop 取完剩余元素返回 false
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRing() = default;
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    bool tryPush(T& value) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ == Capacity) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ == Capacity) {
+                return false;
+            }
+        }
+        slots_[tail & (Capacity - 1)] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) {
+                return false;
+            }
+        }
+        value = std::move(slots_[head & (Capacity - 1)]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push(T value) {
+        while (!tryPush(value)) {
+            wait(producerWaiting_, [&] { return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) != Capacity; });
+        }
+        wake(consumerWaiting_);
+    }
+
+    // 取到元素返回 true；队列已关闭并且取空时返回 false
+    bool pop(T& value) {
+        while (!tryPop(value)) {
+            if (closed_.load(std::memory_order_acquire)) {
+                // close 之前的 push 对这里可见，再取一次避免漏掉最后的元素
+                return tryPop(value);
+            }
+            wait(consumerWaiting_, [&] {
+                return head_.load(std::memory_order_relaxed) != tail_.load(std::memory_order_acquire) || closed_.load(std::memory_order_acquire);
+            });
+        }
+        wake(producerWaiting_);
+        return true;
+    }
+
+    // 生产者不再 push
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        wake(consumerWaiting_);
+    }
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+
+    // 先登记 waiting 再检查条件，与 wake 中先改队列再检查 waiting 配对（两边都有全序栅栏），
+    // 因此要么这里看到对方的修改，要么对方看到登记并在锁内唤醒，不会漏掉
+    template <typename Ready>
+    void wait(std::atomic<bool>& waiting, Ready ready) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeup_.wait(lock, ready);
+        waiting.store(false, std::memory_order_relaxed);
+    }
+
+    void wake(std::atomic<bool>& waiting) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wakeup_.notify_all();
+        }
+    }
+
+    T slots_[Capacity];
+    alignas(kCacheLine) std::atomic<std::size_t> head_{ 0 };
+    std::size_t tailCache_ = 0;   // 消费者看到的 tail_
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{ 0 };
+    std::size_t headCache_ = 0;   // 生产者看到的 head_
+    alignas(kCacheLine) std::atomic<bool> closed_{ false };
+    std::atomic<bool> producerWaiting_{ false };
+    std::atomic<bool> consumerWaiting_{ false };
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+};
@@ -0,0 +1,79 @@
+﻿#include "StringPool.h"
+#include <cstring>
+
+namespace {
+    char unescape(char c) {
+        switch (c) {
+        case 'n':
+            return '\n';
+        case 't':
+            return '\t';
+        case 'r':
+            return '\r';
+        case '0':
+            return '\0';
+        default:
+            return c;  // \\ \" 以及其他字符原样保留
+        }
+    }
+}
+
+std::uint32_t StringPool::intern(std::string_view literal, bool copy) {
+    auto it = index_.find(literal);
+    if (it != index_.end()) {
+        return it->second;
+    }
+    if (copy) {
+        owned_.emplace_back(literal);
+        literal = owned_.back();
+    }
+    std::uint32_t id = static_cast<std::uint32_t>(entries_.size());
+    bool escaped = !literal.empty() && std::memchr(literal.data(), '\\', literal.size()) != nullptr;
+    entries_.push_back({ literal, escaped, copy, -1 });
+    index_.emplace(literal, id);
+    return id;
+}
+
+std::string_view StringPool::text(std::uint32_t id) const {
+    const Entry& entry = entries_[id];
+    if (!entry.escaped) {
+        return entry.literal;
+    }
+    if (entry.decoded < 0) {
+        std::string value;
+        value.reserve(entry.literal.size());
+        for (std::size_t i = 0; i < entry.literal.size(); ++i) {
+            char c = entry.literal[i];
+            if (c == '\\' && i + 1 < entry.literal.size()) {
+                c = unescape(entry.literal[++i]);
+            }
+            value += c;
+        }
+        entry.decoded = static_cast<std::int32_t>(decoded_.size());
+        decoded_.push_back(std::move(value));
+    }
+    return decoded_[entry.decoded];
+}
+
+std::vector<std::uint32_t> StringPool::merge(const StringPool& other) {
+    std::vector<std::uint32_t> ids;
+    ids.reserve(other.size());
+    for (const Entry& entry : other.entries_) {
+        // other 复制进来的原文在 other 清空后就失效了，这里也要复制
+        ids.push_back(intern(entry.literal, entry.owned));
+    }
+    return ids;
+}
+
+void StringPool::clear() {
+    entries_.clear();
+    index_.clear();
+    owned_.clear();
+    decoded_.clear();
+}
+
+void writeStringTable(const StringPool& strings, OutputBuffer& out) {
+    for (std::uint32_t id = 0; id < strings.size(); ++id) {
+        out << '"' << strings.literal(id) << "\"\n";
+    }
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "OutputBuffer.h"
+
+// 字符串常量池：相同的字符串常量只存一份，单词、语法树和汇编的数据段都用下标引用
+//
+// 保存的是源程序中两个引号之间的原文，默认直接引用源文本，不复制；源文本必须比 StringPool 活得更久。
+// 不在源文本中的原文（例如从中间文件读入的）用 intern(literal, true) 复制一份。
+// 转义只在用到 text 时处理，并且只处理含有反斜杠的常量，其余常量的 text 就是原文本身
+class StringPool {
+public:
+    static constexpr std::uint32_t kNoString = 0xffffffffu;
+
+    StringPool() = default;
+    // 常量引用 owned_ 中的字符串，复制之后会指向原来的对象；移动时 deque 中的元素不搬家
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+    StringPool(StringPool&&) = default;
+    StringPool& operator=(StringPool&&) = default;
+
+    // 返回常量的下标，相同的原文返回同一个下标
+    std::uint32_t intern(std::string_view literal, bool copy = false);
+
+    std::size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    // 引号之间的原文
+    std::string_view literal(std::uint32_t id) const { return entries_[id].literal; }
+
+    // 处理转义之后的内容，第一次用到时才转换
+    std::string_view text(std::uint32_t id) const;
+
+    // 把 other 的常量并进来，返回 other 中每个下标对应的新下标
+    std::vector<std::uint32_t> merge(const StringPool& other);
+
+    void clear();
+
+private:
+    struct Entry {
+        std::string_view literal;
+        bool escaped;                 // 原文中有反斜杠
+        bool owned;                   // 原文复制在 owned_ 中
+        mutable std::int32_t decoded; // 转换结果在 decoded_ 中的位置，-1 表示还没有转换
+    };
+
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string_view, std::uint32_t> index_;
+    std::deque<std::string> owned_;            // 复制进来的原文，deque 保证已有元素的地址不变
+    mutable std::deque<std::string> decoded_;
+};
+
+// 中间文件中的字符串常量表：每行一个带引号的原文，按下标顺序排列
+void writeStringTable(const StringPool& strings, OutputBuffer& out);
@@ -0,0 +1,38 @@
+﻿#include "SymbolTable.h"
+
+std::uint32_t SymbolTable::intern(std::string_view name) {
+    auto result = index_.emplace(name, static_cast<std::uint32_t>(symbols_.size()));
+    if (result.second) {
+        symbols_.push_back({ name });
+        assigned_.push_back(0);
+    }
+    return result.first->second;
+}
+
+void SymbolTable::assign(std::uint32_t id) {
+    if (!assigned_[id]) {
+        assigned_[id] = 1;
+        assignments_.push_back(id);
+    }
+}
+
+std::vector<std::uint32_t> SymbolTable::leaveScope() {
+    std::size_t start = scopes_.back();
+    scopes_.pop_back();
+    std::vector<std::uint32_t> undone(assignments_.begin() + static_cast<std::ptrdiff_t>(start), assignments_.end());
+    for (std::uint32_t id : undone) {
+        assigned_[id] = 0;
+    }
+    assignments_.resize(start);
+    return undone;
+}
+
+void SymbolTable::clear() {
+    symbols_.clear();
+    index_.clear();
+    references_.clear();
+    pinned_.clear();
+    assigned_.clear();
+    assignments_.clear();
+    scopes_.clear();
+}
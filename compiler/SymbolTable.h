@@ -0,0 +1,83 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 一个编译单元的符号表
+//
+// 变量名经散列表映射到从 0 开始的连续编号，数据流分析直接用编号索引位向量。
+// 名字引用语法树的名字池，不复制，符号表不能比语法树活得更久。
+// 语言中的变量不需要声明，都属于整个编译单元；作用域记录的是“已经赋过值”：
+// 每个分支是一层作用域，离开时撤销其中新赋值的变量，由调用者决定哪些在 if 语句之后仍然算赋过值
+class SymbolTable {
+public:
+    static constexpr std::uint32_t kNoSymbol = 0xffffffffu;
+
+    struct Symbol {
+        std::string_view name;
+        std::uint32_t length = 0;       // 数组的元素个数，标量为 0
+        std::uint32_t definitions = 0;  // 赋值（包括数组声明和给元素赋值）的次数
+        std::uint32_t uses = 0;         // 读取的次数
+    };
+
+    // 返回变量的编号，第一次出现时加入符号表
+    std::uint32_t intern(std::string_view name);
+
+    // 不在符号表中时返回 kNoSymbol
+    std::uint32_t find(std::string_view name) const {
+        auto it = index_.find(name);
+        return it == index_.end() ? kNoSymbol : it->second;
+    }
+
+    // 记下语法树中第 node 个节点引用的变量，之后的分析直接按节点取编号，不再查散列表
+    void bind(std::uint32_t node, std::uint32_t id) {
+        if (node >= references_.size()) {
+            references_.resize(node + 1, kNoSymbol);
+        }
+        references_[node] = id;
+    }
+
+    // 按语法树的节点数预留 bind 用的空间
+    void reserve(std::size_t nodes) { references_.resize(nodes, kNoSymbol); }
+
+    std::uint32_t reference(std::uint32_t node) const {
+        return node < references_.size() ? references_[node] : kNoSymbol;
+    }
+
+    // 记下生成代码时会报错的语句，删除死代码时保留它
+    void pin(std::uint32_t node) {
+        if (node >= pinned_.size()) {
+            pinned_.resize(node + 1, 0);
+        }
+        pinned_[node] = 1;
+    }
+
+    bool pinned(std::uint32_t node) const { return node < pinned_.size() && pinned_[node] != 0; }
+
+    std::size_t size() const { return symbols_.size(); }
+    Symbol& symbol(std::uint32_t id) { return symbols_[id]; }
+    const Symbol& symbol(std::uint32_t id) const { return symbols_[id]; }
+
+    bool assigned(std::uint32_t id) const { return assigned_[id] != 0; }
+
+    // 在当前作用域中记为已赋值
+    void assign(std::uint32_t id);
+
+    void enterScope() { scopes_.push_back(assignments_.size()); }
+
+    // 撤销当前作用域中新赋值的变量，返回这些变量的编号
+    std::vector<std::uint32_t> leaveScope();
+
+    void clear();
+
+private:
+    std::vector<Symbol> symbols_;
+    std::unordered_map<std::string_view, std::uint32_t> index_;
+    std::vector<std::uint32_t> references_;  // 节点 → 变量编号
+    std::vector<char> pinned_;               // 按节点记录，只在有语句要保留时分配
+    std::vector<char> assigned_;
+    std::vector<std::uint32_t> assignments_;  // 按时间顺序记录新赋值的变量
+    std::vector<std::size_t> scopes_;         // 每层作用域在 assignments_ 中的起点
+};
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池：每个工作线程有自己的任务队列，从队尾取自己的任务，
+// 自己的队列空了就从别的线程的队首偷任务，长短不一的任务也能把所有核用满
+class ThreadPool {
+public:
+    // threads 为 0 时使用硬件线程数
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 工作线程内提交的任务放进自己的队列，其他线程提交的任务轮流分给各个队列
+    void submit(std::function<void()> task);
+
+    // 等待已提交的任务全部完成；任务抛出的第一个异常在这里重新抛出
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(threads_.size()); }
+
+    // 从其他线程的队列偷到的任务数
+    std::size_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void run(unsigned index);
+    bool take(unsigned index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;   // 有新任务或要退出
+    std::condition_variable idle_;   // 任务全部完成
+    std::atomic<std::size_t> queued_{ 0 };    // 还在队列中的任务
+    std::atomic<std::size_t> pending_{ 0 };   // 还没完成的任务（包括正在执行的）
+    std::atomic<unsigned> next_{ 0 };
+    std::atomic<std::size_t> steals_{ 0 };
+    bool stopping_ = false;
+    std::exception_ptr error_;
+};
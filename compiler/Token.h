@@ -0,0 +1,95 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 单词种别码
+enum class TokenCode {
+    Identifier,
+    Integer,
+    Operator,
+    Delimiter,
+    Keyword,
+    Error,
+    Print,
+    StringLiteral
+};
+
+// 词法单元：种别码、在源文件中的字节偏移以及单词值；行列号用 LineIndex 按需换算
+struct Token {
+    TokenCode code;
+    std::uint32_t offset;
+    std::string value;
+};
+
+// 运算符表（只读，多个线程可以同时使用）
+inline const std::unordered_map<std::string, TokenCode> operatorMap = {
+    { "+", TokenCode::Operator },
+    { "-", TokenCode::Operator },
+    { "*", TokenCode::Operator },
+    { "/", TokenCode::Operator },
+    { "=", TokenCode::Operator },
+    { "++", TokenCode::Operator },
+    { "--", TokenCode::Operator },
+    { "<", TokenCode::Operator },
+    { ">", TokenCode::Operator },
+    { "<=", TokenCode::Operator },
+    { ">=", TokenCode::Operator },
+    { "==", TokenCode::Operator },
+    { "!=", TokenCode::Operator }
+};
+
+// 查找运算符，不是运算符时返回 false
+inline bool lookupOperator(const std::string& symbol, TokenCode& code) {
+    auto it = operatorMap.find(symbol);
+    if (it == operatorMap.end()) {
+        return false;
+    }
+    code = it->second;
+    return true;
+}
+
+// 比较运算符只能出现在 if 的条件中
+inline bool isComparisonOperator(std::string_view symbol) {
+    return symbol == "<" || symbol == ">" || symbol == "<=" || symbol == ">=" || symbol == "==" || symbol == "!=";
+}
+
+// tokens.txt 中使用的种别名称
+inline const char* tokenCodeName(TokenCode code) {
+    switch (code) {
+    case TokenCode::Identifier:
+        return "Identifier";
+    case TokenCode::Integer:
+        return "Integer";
+    case TokenCode::Operator:
+        return "Operator";
+    case TokenCode::Delimiter:
+        return "Delimiter";
+    case TokenCode::Keyword:
+        return "Keyword";
+    case TokenCode::Error:
+        return "Error";
+    case TokenCode::Print:
+        return "Print";
+    case TokenCode::StringLiteral:
+        return "StringLiteral";
+    default:
+        return "Unknown";
+    }
+}
+
+// 由种别名称得到种别码，未知名称返回 false
+inline bool tokenCodeFromName(std::string_view name, TokenCode& code) {
+    static const TokenCode codes[] = {
+        TokenCode::Identifier, TokenCode::Integer, TokenCode::Operator, TokenCode::Delimiter,
+        TokenCode::Keyword, TokenCode::Error, TokenCode::Print, TokenCode::StringLiteral
+    };
+    for (TokenCode candidate : codes) {
+        if (name == tokenCodeName(candidate)) {
+            code = candidate;
+            return true;
+        }
+    }
+    return false;
+}
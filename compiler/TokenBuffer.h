@@ -0,0 +1,132 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 结构数组（SoA）形式的单词序列：种别、值的偏移和长度分别存放在紧凑的并行数组中
+// 每个单词 9 字节，而 Token（含 std::string）为 40 字节；判断单词种别只需扫描连续的字节数组
+//
+// 单词的值默认是源文本中的一段，只记录偏移和长度；源文本必须比 TokenBuffer 活得更久
+// 不在源文本中的值（例如从 tokens.txt 读入的单词）复制到内部的字符串池
+// 行列号不随单词保存，需要时用 LineIndex 由 offset(i) 换算
+// 字符串常量在 StringPool 中的下标记在单独的表里，不占用每个单词的空间
+template <typename Kind>
+class TokenBuffer {
+public:
+    TokenBuffer() = default;
+    explicit TokenBuffer(std::string_view source) : source_(source) {}
+
+    // 清空单词并换一份源文本，保留已分配的容量
+    void reset(std::string_view source) {
+        source_ = source;
+        pool_.clear();
+        kinds_.clear();
+        offsets_.clear();
+        lengths_.clear();
+        literals_.clear();
+    }
+
+    void reserve(std::size_t count) {
+        kinds_.reserve(count);
+        offsets_.reserve(count);
+        lengths_.reserve(count);
+    }
+
+    // 值为 source[offset, offset + length)
+    void push(Kind kind, std::size_t offset, std::size_t length) {
+        kinds_.push_back(static_cast<std::uint8_t>(kind));
+        offsets_.push_back(static_cast<std::uint32_t>(offset));
+        lengths_.push_back(static_cast<std::uint32_t>(length));
+    }
+
+    // 字符串常量：值为源文本中带引号的原文，literal 为常量池中的下标
+    void pushLiteral(Kind kind, std::size_t offset, std::size_t length, std::uint32_t literal) {
+        literals_.push_back({ static_cast<std::uint32_t>(kinds_.size()), literal });
+        push(kind, offset, length);
+    }
+
+    // 值复制到字符串池，这样的单词没有源文本中的位置
+    void pushOwned(Kind kind, std::string_view value) {
+        kinds_.push_back(static_cast<std::uint8_t>(kind));
+        offsets_.push_back(static_cast<std::uint32_t>(pool_.size()) | kPoolBit);
+        lengths_.push_back(static_cast<std::uint32_t>(value.size()));
+        pool_.append(value.data(), value.size());
+    }
+
+    // 追加另一个引用同一份源文本的单词序列（例如流水线中逐批得到的单词）
+    void append(const TokenBuffer& other) {
+        std::uint32_t poolBase = static_cast<std::uint32_t>(pool_.size());
+        kinds_.insert(kinds_.end(), other.kinds_.begin(), other.kinds_.end());
+        lengths_.insert(lengths_.end(), other.lengths_.begin(), other.lengths_.end());
+        for (std::uint32_t offset : other.offsets_) {
+            offsets_.push_back(offset & kPoolBit ? offset + poolBase : offset);
+        }
+        pool_ += other.pool_;
+        std::uint32_t tokenBase = static_cast<std::uint32_t>(kinds_.size() - other.kinds_.size());
+        for (const auto& literal : other.literals_) {
+            literals_.push_back({ literal.first + tokenBase, literal.second });
+        }
+    }
+
+    std::size_t size() const { return kinds_.size(); }
+    bool empty() const { return kinds_.empty(); }
+
+    Kind kind(std::size_t i) const { return static_cast<Kind>(kinds_[i]); }
+    bool is(std::size_t i, Kind k) const { return i < kinds_.size() && kinds_[i] == static_cast<std::uint8_t>(k); }
+
+    std::string_view value(std::size_t i) const {
+        std::uint32_t offset = offsets_[i];
+        if (offset & kPoolBit) {
+            return std::string_view(pool_.data() + (offset & ~kPoolBit), lengths_[i]);
+        }
+        return source_.substr(offset, lengths_[i]);
+    }
+
+    // 单词在源文本中的字节偏移；值在字符串池中时返回 kNoOffset
+    static constexpr std::size_t kNoOffset = static_cast<std::size_t>(-1);
+    std::size_t offset(std::size_t i) const {
+        std::uint32_t offset = offsets_[i];
+        return offset & kPoolBit ? kNoOffset : offset;
+    }
+
+    // 第 i 个单词在常量池中的下标；不是用 pushLiteral 加入的单词返回 kNoLiteral
+    static constexpr std::uint32_t kNoLiteral = 0xffffffffu;
+    std::uint32_t literal(std::size_t i) const {
+        // 表按单词顺序排列，二分查找
+        auto it = std::lower_bound(literals_.begin(), literals_.end(), std::make_pair(static_cast<std::uint32_t>(i), 0u));
+        return it != literals_.end() && it->first == i ? it->second : kNoLiteral;
+    }
+
+    // 从 from 开始查找下一个种别为 k 的单词，找不到时返回 size()
+    std::size_t find(Kind k, std::size_t from = 0) const {
+        if (from >= kinds_.size()) {
+            return kinds_.size();
+        }
+        const void* hit = std::memchr(kinds_.data() + from, static_cast<int>(k), kinds_.size() - from);
+        return hit ? static_cast<const std::uint8_t*>(hit) - kinds_.data() : kinds_.size();
+    }
+
+    // 种别数组本身，供需要批量扫描的调用者使用
+    const std::uint8_t* kinds() const { return kinds_.data(); }
+
+    // 当前占用的字节数（不含源文本）
+    std::size_t memoryUsage() const {
+        return kinds_.capacity() * sizeof(std::uint8_t) + offsets_.capacity() * sizeof(std::uint32_t) +
+            lengths_.capacity() * sizeof(std::uint32_t) + pool_.capacity() +
+            literals_.capacity() * sizeof(literals_[0]);
+    }
+
+private:
+    static constexpr std::uint32_t kPoolBit = 1u << 31;
+
+    std::string_view source_;
+    std::string pool_;
+    std::vector<std::uint8_t> kinds_;
+    std::vector<std::uint32_t> offsets_;
+    std::vector<std::uint32_t> lengths_;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> literals_;   // （单词序号，常量池下标）
+};
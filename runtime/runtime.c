@@ -0,0 +1,92 @@
+﻿/* 生成代码的运行时库：与 GasProgram 输出的 .s 一起编译链接
+ *
+ *   cc -O2 -no-pie -o prog prog.s runtime/runtime.c
+ *   ./prog [运行次数]
+ *
+ * 先运行一次 compiled_main，print 的输出写到标准输出，结束后把所有变量的值写到标准错误；
+ * 然后关掉输出、每次把变量清零后再运行指定的次数，用 rdtsc 统计每次运行的周期数（TSC 周期）
+ */
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <x86intrin.h>
+
+struct variable {
+    const char* name;
+    int32_t* address;
+    int64_t length;
+};
+
+extern const struct variable compiled_variables[];
+extern const int64_t compiled_variable_count;
+void compiled_main(void);
+
+static int quiet = 0;
+
+void print_int(int32_t value) {
+    if (!quiet) {
+        printf("%" PRId32 "\n", value);
+    }
+}
+
+/* 字符串常量：长度在前，内容中可以有 '\0'，不以 '\0' 结尾 */
+struct string {
+    int64_t length;
+    char text[];
+};
+
+void print_string(const struct string* string) {
+    if (!quiet) {
+        fwrite(string->text, 1, (size_t)string->length, stdout);
+    }
+}
+
+void runtime_bounds_error(void) {
+    fflush(stdout);
+    fputs("error: array index out of bounds\n", stderr);
+    exit(3);
+}
+
+static void reset_variables(void) {
+    for (int64_t i = 0; i < compiled_variable_count; ++i) {
+        memset(compiled_variables[i].address, 0, (size_t)compiled_variables[i].length * sizeof(int32_t));
+    }
+}
+
+int main(int argc, char** argv) {
+    long runs = argc > 1 ? atol(argv[1]) : 1000;
+
+    compiled_main();
+    fflush(stdout);
+    for (int64_t i = 0; i < compiled_variable_count; ++i) {
+        const struct variable* v = &compiled_variables[i];
+        fprintf(stderr, "%s =", v->name);
+        for (int64_t j = 0; j < v->length; ++j) {
+            fprintf(stderr, " %" PRId32, v->address[j]);
+        }
+        fputc('\n', stderr);
+    }
+
+    quiet = 1;
+    uint64_t total = 0;
+    uint64_t best = UINT64_MAX;
+    for (long r = 0; r < runs; ++r) {
+        reset_variables();
+        _mm_lfence();
+        uint64_t start = __rdtsc();
+        _mm_lfence();
+        compiled_main();
+        _mm_lfence();
+        uint64_t cycles = __rdtsc() - start;
+        total += cycles;
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+    if (runs > 0) {
+        fprintf(stderr, "cycles: mean %.1f min %" PRIu64 " runs %ld\n", (double)total / (double)runs, best, runs);
+    }
+    return 0;
+}
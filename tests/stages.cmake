@@ -0,0 +1,36 @@
+# 依次运行四个阶段的命令行程序：源程序 -> 记号 -> 语法树 -> 逆波兰式 -> 汇编
+# 用法：cmake -DSTAGES=<程序目录> -DSOURCES=<tests/run> -DWORK=<工作目录> -P stages.cmake
+# 各阶段读写 d:/ 和 D:/ 下的文件，这里在工作目录中建出这两个目录
+
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK}/d:)
+file(CREATE_LINK d: ${WORK}/D: SYMBOLIC)
+
+file(GLOB programs ${SOURCES}/*.txt)
+set(failed 0)
+foreach(program ${programs})
+    get_filename_component(name ${program} NAME)
+    configure_file(${program} ${WORK}/d:/source_code.txt COPYONLY)
+    file(REMOVE ${WORK}/d:/output_TRP.txt ${WORK}/d:/output.asm)
+    foreach(stage latexanaly Pareranaly convertToReversePolish Target)
+        execute_process(COMMAND ${STAGES}/${stage}
+            WORKING_DIRECTORY ${WORK}
+            RESULT_VARIABLE result
+            OUTPUT_QUIET
+            ERROR_VARIABLE errors)
+        # 有的阶段出错时只在 stderr 报告，返回值仍是 0
+        if(NOT result EQUAL 0 OR NOT errors STREQUAL "")
+            message("FAIL ${name}: ${stage} exited with ${result}\n${errors}")
+            math(EXPR failed "${failed} + 1")
+            break()
+        endif()
+    endforeach()
+    if(result EQUAL 0 AND errors STREQUAL "" AND NOT EXISTS ${WORK}/d:/output.asm)
+        message("FAIL ${name}: no output.asm")
+        math(EXPR failed "${failed} + 1")
+    endif()
+endforeach()
+
+if(failed)
+    message(FATAL_ERROR "${failed} program(s) failed")
+endif()